@@ -372,6 +372,19 @@ void CBasicBlock::SetRecycleCount(uint32 recycleCount)
 	m_recycleCount = recycleCount;
 }
 
+CBasicBlock* CBasicBlock::GetCachedExitTarget(uint32 address, uint32 generation) const
+{
+	if((m_exitTargetAddress != address) || (m_exitTargetGeneration != generation)) return nullptr;
+	return m_exitTarget;
+}
+
+void CBasicBlock::SetCachedExitTarget(uint32 address, uint32 generation, CBasicBlock* target)
+{
+	m_exitTargetAddress = address;
+	m_exitTargetGeneration = generation;
+	m_exitTarget = target;
+}
+
 bool CBasicBlock::HasLinkSlot(LINK_SLOT linkSlot) const
 {
 	return m_linkBlockTrampolineOffset[linkSlot] != INVALID_LINK_SLOT;
@@ -84,6 +84,9 @@ public:
 	uint32 GetRecycleCount() const;
 	void SetRecycleCount(uint32);
 
+	CBasicBlock* GetCachedExitTarget(uint32, uint32) const;
+	void SetCachedExitTarget(uint32, uint32, CBasicBlock*);
+
 	bool HasLinkSlot(LINK_SLOT) const;
 	BlockOutLinkPointer GetOutLink(LINK_SLOT) const;
 	void SetOutLink(LINK_SLOT, BlockOutLinkPointer);
@@ -126,6 +129,11 @@ private:
 	void (*m_function)(void*);
 #endif
 	uint32 m_recycleCount = 0;
+	//Last block reached when this block returned to the executor (ie.: indirect jump target),
+	//only valid while the executor's block generation matches
+	uint32 m_exitTargetAddress = MIPS_INVALID_PC;
+	uint32 m_exitTargetGeneration = 0;
+	CBasicBlock* m_exitTarget = nullptr;
 	BlockOutLinkPointer m_outLinks[LINK_SLOT_MAX];
 	uint32 m_linkBlockTrampolineOffset[LINK_SLOT_MAX];
 #ifdef _DEBUG
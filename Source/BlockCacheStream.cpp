@@ -0,0 +1,132 @@
+#include "BlockCacheStream.h"
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+CBlockCacheStream::CBlockCacheStream(std::unique_ptr<Framework::CStream> baseStream, uint32 blockSize, uint32 maxBlockCount, uint32 readAheadBlockCount)
+    : m_baseStream(std::move(baseStream))
+    , m_blockSize(blockSize)
+    , m_readAheadBlockCount(std::max<uint32>(readAheadBlockCount, 1))
+    , m_blocks(maxBlockCount)
+{
+	assert(m_blockSize != 0);
+	//Read ahead blocks must not evict the block that was requested
+	assert(m_readAheadBlockCount <= maxBlockCount);
+	m_size = m_baseStream->GetLength();
+}
+
+void CBlockCacheStream::Seek(int64 position, Framework::STREAM_SEEK_DIRECTION whence)
+{
+	switch(whence)
+	{
+	case Framework::STREAM_SEEK_SET:
+		m_position = position;
+		break;
+	case Framework::STREAM_SEEK_CUR:
+		m_position += position;
+		break;
+	case Framework::STREAM_SEEK_END:
+		m_position = m_size + position;
+		break;
+	}
+	m_isEof = false;
+}
+
+uint64 CBlockCacheStream::Tell()
+{
+	return m_position;
+}
+
+uint64 CBlockCacheStream::Read(void* buffer, uint64 length)
+{
+	if(m_position >= m_size)
+	{
+		m_isEof = true;
+		return 0;
+	}
+
+	length = std::min<uint64>(length, m_size - m_position);
+
+	auto outputBuffer = reinterpret_cast<uint8*>(buffer);
+	uint64 readRemain = length;
+	while(readRemain != 0)
+	{
+		uint64 blockIndex = m_position / m_blockSize;
+		uint64 blockOffset = m_position % m_blockSize;
+		const auto& block = GetBlock(blockIndex);
+		assert(blockOffset < block.size());
+		uint64 toRead = std::min<uint64>(block.size() - blockOffset, readRemain);
+		memcpy(outputBuffer, block.data() + blockOffset, toRead);
+		outputBuffer += toRead;
+		m_position += toRead;
+		readRemain -= toRead;
+	}
+
+	return length;
+}
+
+uint64 CBlockCacheStream::Write(const void*, uint64)
+{
+	assert(false);
+	return 0;
+}
+
+bool CBlockCacheStream::IsEOF()
+{
+	return m_isEof;
+}
+
+const CBlockCacheStream::Block& CBlockCacheStream::GetBlock(uint64 blockIndex)
+{
+	if(auto block = m_blocks.Find(blockIndex))
+	{
+		return *block;
+	}
+
+	//Read the requested block along with following blocks that aren't cached yet, in a single request
+	uint64 totalBlockCount = (m_size + m_blockSize - 1) / m_blockSize;
+	uint32 readBlockCount = 1;
+	while((readBlockCount < m_readAheadBlockCount) && ((blockIndex + readBlockCount) < totalBlockCount))
+	{
+		if(m_blocks.Contains(blockIndex + readBlockCount)) break;
+		readBlockCount++;
+	}
+
+	uint64 readPosition = blockIndex * m_blockSize;
+	uint64 readSize = std::min<uint64>(readBlockCount * m_blockSize, m_size - readPosition);
+	m_readBuffer.resize(readSize);
+	m_baseStream->Seek(readPosition, Framework::STREAM_SEEK_SET);
+	uint64 readAmount = m_baseStream->Read(m_readBuffer.data(), readSize);
+	if(readAmount != readSize)
+	{
+		if(m_baseStream->IsEOF())
+		{
+			//Image is shorter than advertised, anything past its end reads as zeros
+			std::fill(m_readBuffer.begin() + readAmount, m_readBuffer.end(), 0);
+		}
+		else
+		{
+			//Only keep blocks that were read completely, don't cache stale buffer contents
+			readBlockCount = static_cast<uint32>(readAmount / m_blockSize);
+			if(readBlockCount == 0)
+			{
+				throw std::runtime_error("Failed to read block from base stream.");
+			}
+			readSize = static_cast<uint64>(readBlockCount) * m_blockSize;
+		}
+	}
+
+	//Insert in reverse order to have the requested block be the most recently used one
+	for(uint32 i = readBlockCount; i > 0; i--)
+	{
+		uint64 blockOffset = static_cast<uint64>(i - 1) * m_blockSize;
+		uint64 blockSize = std::min<uint64>(m_blockSize, readSize - blockOffset);
+		auto blockBegin = m_readBuffer.begin() + blockOffset;
+		m_blocks.Insert(blockIndex + i - 1, Block(blockBegin, blockBegin + blockSize));
+	}
+
+	auto block = m_blocks.Find(blockIndex);
+	assert(block);
+	return *block;
+}
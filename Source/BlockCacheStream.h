@@ -0,0 +1,36 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "Types.h"
+#include "Stream.h"
+#include "LruCache.h"
+
+//Read-only stream that keeps recently accessed blocks of a base stream in memory.
+//On a miss, a few following blocks are also read in the same request.
+class CBlockCacheStream : public Framework::CStream
+{
+public:
+	CBlockCacheStream(std::unique_ptr<Framework::CStream>, uint32 blockSize, uint32 maxBlockCount, uint32 readAheadBlockCount);
+	virtual ~CBlockCacheStream() = default;
+
+	void Seek(int64, Framework::STREAM_SEEK_DIRECTION) override;
+	uint64 Tell() override;
+	uint64 Read(void*, uint64) override;
+	uint64 Write(const void*, uint64) override;
+	bool IsEOF() override;
+
+private:
+	typedef std::vector<uint8> Block;
+
+	const Block& GetBlock(uint64);
+
+	std::unique_ptr<Framework::CStream> m_baseStream;
+	uint32 m_blockSize = 0;
+	uint32 m_readAheadBlockCount = 0;
+	uint64 m_size = 0;
+	uint64 m_position = 0;
+	bool m_isEof = false;
+	CLruCache<uint64, Block> m_blocks;
+	std::vector<uint8> m_readBuffer;
+};
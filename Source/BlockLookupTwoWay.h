@@ -4,6 +4,9 @@
 #include "Types.h"
 #include "BasicBlock.h"
 
+//Two level lookup table. Sub tables that don't contain any block all point to a shared
+//sub table filled with the empty block, this way, lookups never need to check for null
+//sub tables and boil down to two loads.
 class BlockLookupTwoWay
 {
 public:
@@ -14,21 +17,23 @@ public:
 	{
 		m_subTableCount = (maxAddress + SUBTABLE_MASK) / SUBTABLE_SIZE;
 		assert(m_subTableCount != 0);
+		m_emptySubTable = new BlockType[SUBTABLE_ENTRY_COUNT];
+		for(uint32 i = 0; i < SUBTABLE_ENTRY_COUNT; i++)
+		{
+			m_emptySubTable[i] = m_emptyBlock;
+		}
 		m_blockTable = new BlockType*[m_subTableCount];
-		memset(m_blockTable, 0, sizeof(BlockType*) * m_subTableCount);
+		for(unsigned int i = 0; i < m_subTableCount; i++)
+		{
+			m_blockTable[i] = m_emptySubTable;
+		}
 	}
 
 	~BlockLookupTwoWay()
 	{
-		for(unsigned int i = 0; i < m_subTableCount; i++)
-		{
-			auto subTable = m_blockTable[i];
-			if(subTable)
-			{
-				delete[] subTable;
-			}
-		}
+		Clear();
 		delete[] m_blockTable;
+		delete[] m_emptySubTable;
 	}
 
 	void Clear()
@@ -36,10 +41,10 @@ public:
 		for(unsigned int i = 0; i < m_subTableCount; i++)
 		{
 			auto subTable = m_blockTable[i];
-			if(subTable)
+			if(subTable != m_emptySubTable)
 			{
 				delete[] subTable;
-				m_blockTable[i] = nullptr;
+				m_blockTable[i] = m_emptySubTable;
 			}
 		}
 	}
@@ -51,11 +56,10 @@ public:
 		uint32 loAddress = address & SUBTABLE_MASK;
 		assert(hiAddress < m_subTableCount);
 		auto& subTable = m_blockTable[hiAddress];
-		if(!subTable)
+		if(subTable == m_emptySubTable)
 		{
-			const uint32 subTableSize = SUBTABLE_SIZE / INSTRUCTION_SIZE;
-			subTable = new BlockType[subTableSize];
-			for(uint32 i = 0; i < subTableSize; i++)
+			subTable = new BlockType[SUBTABLE_ENTRY_COUNT];
+			for(uint32 i = 0; i < SUBTABLE_ENTRY_COUNT; i++)
 			{
 				subTable[i] = m_emptyBlock;
 			}
@@ -71,7 +75,7 @@ public:
 		uint32 loAddress = address & SUBTABLE_MASK;
 		assert(hiAddress < m_subTableCount);
 		auto& subTable = m_blockTable[hiAddress];
-		assert(subTable);
+		assert(subTable != m_emptySubTable);
 		assert(subTable[loAddress / INSTRUCTION_SIZE] != m_emptyBlock);
 		subTable[loAddress / INSTRUCTION_SIZE] = m_emptyBlock;
 	}
@@ -81,10 +85,7 @@ public:
 		uint32 hiAddress = address >> SUBTABLE_BITS;
 		uint32 loAddress = address & SUBTABLE_MASK;
 		assert(hiAddress < m_subTableCount);
-		auto& subTable = m_blockTable[hiAddress];
-		if(!subTable) return m_emptyBlock;
-		auto result = subTable[loAddress / INSTRUCTION_SIZE];
-		return result;
+		return m_blockTable[hiAddress][loAddress / INSTRUCTION_SIZE];
 	}
 
 private:
@@ -94,9 +95,11 @@ private:
 		SUBTABLE_SIZE = (1 << SUBTABLE_BITS),
 		SUBTABLE_MASK = (SUBTABLE_SIZE - 1),
 		INSTRUCTION_SIZE = 4,
+		SUBTABLE_ENTRY_COUNT = (SUBTABLE_SIZE / INSTRUCTION_SIZE),
 	};
 
 	BlockType m_emptyBlock = nullptr;
+	BlockType* m_emptySubTable = nullptr;
 	BlockType** m_blockTable = nullptr;
 	uint32 m_subTableCount = 0;
 };
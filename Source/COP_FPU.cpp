@@ -550,6 +550,17 @@ void CCOP_FPU::CVT_S_W()
 //31
 void CCOP_FPU::LWC1()
 {
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(4);
+
+		m_codeGen->LoadFromRefIdx(1);
+		m_codeGen->PullRel(offsetof(CMIPS, m_State.nCOP1[m_ft]));
+		m_codeGen->Else();
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -584,11 +595,27 @@ void CCOP_FPU::LWC1()
 	{
 		m_codeGen->EndIf();
 	}
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 //39
 void CCOP_FPU::SWC1()
 {
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(4);
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nCOP1[m_ft]));
+		m_codeGen->StoreAtRefIdx(1);
+		m_codeGen->Else();
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -622,6 +649,11 @@ void CCOP_FPU::SWC1()
 	{
 		m_codeGen->EndIf();
 	}
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 //////////////////////////////////////////////////
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cassert>
+#include "EventScheduler.h"
+
+CEventScheduler::CEventScheduler(unsigned int eventCount)
+    : m_events(eventCount)
+{
+}
+
+void CEventScheduler::Reset()
+{
+	for(auto& event : m_events)
+	{
+		event.lastServiceTime = 0;
+		event.generation = 0;
+		event.scheduled = false;
+	}
+	m_heap.clear();
+	m_dueItems.clear();
+	m_currentTime = 0;
+}
+
+void CEventScheduler::RegisterEvent(unsigned int eventId, const EventHandler& handler)
+{
+	assert(eventId < m_events.size());
+	m_events[eventId].handler = handler;
+}
+
+void CEventScheduler::ScheduleEvent(unsigned int eventId, uint32 delay)
+{
+	assert(eventId < m_events.size());
+	auto& event = m_events[eventId];
+	if(!event.scheduled)
+	{
+		//Device had nothing pending, start counting from now
+		event.lastServiceTime = m_currentTime;
+		event.scheduled = true;
+	}
+	event.generation++;
+
+	HEAP_ITEM item;
+	item.deadline = m_currentTime + delay;
+	item.eventId = eventId;
+	item.generation = event.generation;
+	m_heap.push_back(item);
+	std::push_heap(m_heap.begin(), m_heap.end(), &CEventScheduler::IsHeapItemLater);
+}
+
+void CEventScheduler::CancelEvent(unsigned int eventId)
+{
+	assert(eventId < m_events.size());
+	auto& event = m_events[eventId];
+	event.scheduled = false;
+	//Invalidate any item still present in the heap
+	event.generation++;
+}
+
+bool CEventScheduler::IsEventScheduled(unsigned int eventId) const
+{
+	assert(eventId < m_events.size());
+	return m_events[eventId].scheduled;
+}
+
+uint32 CEventScheduler::GetTicksUntilEvent(unsigned int eventId) const
+{
+	assert(eventId < m_events.size());
+	const auto& event = m_events[eventId];
+	if(!event.scheduled) return NO_EVENT_PENDING;
+	for(const auto& item : m_heap)
+	{
+		if((item.eventId != eventId) || (item.generation != event.generation)) continue;
+		if(item.deadline <= m_currentTime) return 0;
+		return static_cast<uint32>(std::min<uint64>(item.deadline - m_currentTime, NO_EVENT_PENDING - 1));
+	}
+	//Scheduled event should always have an item in the heap
+	assert(false);
+	return 0;
+}
+
+void CEventScheduler::SyncEvent(unsigned int eventId)
+{
+	//Brings a device up to date before its deadline (ie.: before accessing its registers)
+	assert(eventId < m_events.size());
+	auto& event = m_events[eventId];
+	uint32 elapsed = event.scheduled ? static_cast<uint32>(m_currentTime - event.lastServiceTime) : 0;
+	event.lastServiceTime = m_currentTime;
+	if(event.handler)
+	{
+		event.handler(elapsed);
+	}
+}
+
+void CEventScheduler::AdvanceTime(uint32 ticks)
+{
+	m_currentTime += ticks;
+}
+
+void CEventScheduler::ProcessDueEvents()
+{
+	//Gather all due items first, handlers might schedule new events with
+	//no delay and those will only be serviced on the next call
+	assert(m_dueItems.empty());
+	while(!m_heap.empty() && (m_heap.front().deadline <= m_currentTime))
+	{
+		const auto& item = m_heap.front();
+		if(!IsHeapItemStale(item))
+		{
+			m_dueItems.push_back(item);
+		}
+		PopHeapItem();
+	}
+
+	for(const auto& item : m_dueItems)
+	{
+		//A previous handler might have rescheduled or cancelled this event
+		if(IsHeapItemStale(item)) continue;
+		auto& event = m_events[item.eventId];
+		uint32 elapsed = static_cast<uint32>(m_currentTime - event.lastServiceTime);
+		event.scheduled = false;
+		event.lastServiceTime = m_currentTime;
+		if(event.handler)
+		{
+			event.handler(elapsed);
+		}
+	}
+	m_dueItems.clear();
+}
+
+uint64 CEventScheduler::GetCurrentTime() const
+{
+	return m_currentTime;
+}
+
+uint32 CEventScheduler::GetTicksUntilNextEvent()
+{
+	PruneStaleHeapItems();
+	if(m_heap.empty())
+	{
+		return NO_EVENT_PENDING;
+	}
+	uint64 deadline = m_heap.front().deadline;
+	if(deadline <= m_currentTime)
+	{
+		return 0;
+	}
+	return static_cast<uint32>(std::min<uint64>(deadline - m_currentTime, NO_EVENT_PENDING - 1));
+}
+
+bool CEventScheduler::IsHeapItemLater(const HEAP_ITEM& lhs, const HEAP_ITEM& rhs)
+{
+	//Heap functions build a max heap, we want the earliest deadline on top.
+	//Events with the same deadline are serviced in order of their ids.
+	if(lhs.deadline != rhs.deadline)
+	{
+		return lhs.deadline > rhs.deadline;
+	}
+	return lhs.eventId > rhs.eventId;
+}
+
+bool CEventScheduler::IsHeapItemStale(const HEAP_ITEM& item) const
+{
+	const auto& event = m_events[item.eventId];
+	return !event.scheduled || (event.generation != item.generation);
+}
+
+void CEventScheduler::PopHeapItem()
+{
+	std::pop_heap(m_heap.begin(), m_heap.end(), &CEventScheduler::IsHeapItemLater);
+	m_heap.pop_back();
+}
+
+void CEventScheduler::PruneStaleHeapItems()
+{
+	while(!m_heap.empty() && IsHeapItemStale(m_heap.front()))
+	{
+		PopHeapItem();
+	}
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+#include "Types.h"
+
+//Keeps track of timestamped device deadlines. Each device registers a handler that
+//will be called with the amount of ticks elapsed since it was last serviced.
+//Handlers are responsible for scheduling the next deadline of their device.
+class CEventScheduler
+{
+public:
+	typedef std::function<void(uint32)> EventHandler;
+
+	enum : uint32
+	{
+		NO_EVENT_PENDING = ~0U,
+	};
+
+	CEventScheduler(unsigned int);
+	virtual ~CEventScheduler() = default;
+
+	void Reset();
+
+	void RegisterEvent(unsigned int, const EventHandler&);
+	void ScheduleEvent(unsigned int, uint32);
+	void CancelEvent(unsigned int);
+	bool IsEventScheduled(unsigned int) const;
+	uint32 GetTicksUntilEvent(unsigned int) const;
+	void SyncEvent(unsigned int);
+
+	void AdvanceTime(uint32);
+	void ProcessDueEvents();
+
+	uint64 GetCurrentTime() const;
+	uint32 GetTicksUntilNextEvent();
+
+private:
+	struct EVENT
+	{
+		EventHandler handler;
+		uint64 lastServiceTime = 0;
+		uint32 generation = 0;
+		bool scheduled = false;
+	};
+
+	struct HEAP_ITEM
+	{
+		uint64 deadline = 0;
+		unsigned int eventId = 0;
+		uint32 generation = 0;
+	};
+
+	static bool IsHeapItemLater(const HEAP_ITEM&, const HEAP_ITEM&);
+	bool IsHeapItemStale(const HEAP_ITEM&) const;
+	void PopHeapItem();
+	void PruneStaleHeapItems();
+
+	std::vector<EVENT> m_events;
+	std::vector<HEAP_ITEM> m_heap;
+	std::vector<HEAP_ITEM> m_dueItems;
+	uint64 m_currentTime = 0;
+};
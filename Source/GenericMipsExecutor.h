@@ -63,11 +63,25 @@ public:
 		m_mustBreak = false;
 		m_initQuota = cycles;
 #endif
+		CBasicBlock* prevBlock = nullptr;
 		while(m_context.m_State.nHasException == 0)
 		{
 			uint32 address = m_context.m_State.nPC & m_addressMask;
-			auto block = m_blockLookup.FindBlockAt(address);
+			uint32 generation = m_blockGeneration;
+			//Blocks that return here usually go to the same place (indirect jumps), check
+			//the target cached in the previous block before doing a full lookup
+			auto block = prevBlock ? prevBlock->GetCachedExitTarget(address, generation) : nullptr;
+			if(!block)
+			{
+				block = m_blockLookup.FindBlockAt(address);
+				if(prevBlock && !block->IsEmpty())
+				{
+					prevBlock->SetCachedExitTarget(address, generation, block);
+				}
+			}
 			block->Execute();
+			//Blocks might have been cleared while executing, in which case block could be gone
+			prevBlock = ((m_blockGeneration == generation) && !block->IsEmpty()) ? block : nullptr;
 		}
 		m_context.m_State.nHasException &= ~MIPS_EXECUTION_STATUS_QUOTADONE;
 #ifdef DEBUGGER_INCLUDED
@@ -91,6 +105,7 @@ public:
 		m_blockLookup.Clear();
 		m_blocks.clear();
 		m_blockOutLinks.clear();
+		m_blockGeneration++;
 #ifdef DEBUGGER_INCLUDED
 		m_mustBreak = false;
 #endif
@@ -289,6 +304,11 @@ protected:
 			m_blockLookup.DeleteBlock(block);
 		}
 
+		if(clearedBlocks.empty()) return;
+
+		//Invalidate exit targets cached in blocks, they could point to the blocks being cleared
+		m_blockGeneration++;
+
 		//Remove pending block link entries for the blocks that are about to be cleared
 		for(auto& block : clearedBlocks)
 		{
@@ -324,6 +344,7 @@ protected:
 	uint32 m_maxAddress = 0;
 	uint32 m_addressMask = 0;
 	BLOCK_CATEGORY m_blockCategory = BLOCK_CATEGORY_UNKNOWN;
+	uint32 m_blockGeneration = 0;
 
 	BlockLookupType m_blockLookup;
 
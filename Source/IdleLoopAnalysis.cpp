@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <iterator>
+#include "IdleLoopAnalysis.h"
+#include "Ps2Const.h"
+#include "MIPS.h"
+#include "MipsJitter.h"
+#include "offsetof_def.h"
+
+//Loops bigger than this are unlikely to be simple polling loops
+static const uint32 g_maxLoopSize = 0x100;
+
+enum OP
+{
+	OP_SPECIAL = 0x00,
+	OP_REGIMM = 0x01,
+	OP_BEQ = 0x04,
+	OP_BNE = 0x05,
+	OP_BLEZ = 0x06,
+	OP_BGTZ = 0x07,
+	OP_ADDIU = 0x09,
+	OP_SLTI = 0x0A,
+	OP_SLTIU = 0x0B,
+	OP_ANDI = 0x0C,
+	OP_ORI = 0x0D,
+	OP_XORI = 0x0E,
+	OP_LUI = 0x0F,
+	OP_DADDIU = 0x19,
+	OP_LQ = 0x1E,
+	OP_LB = 0x20,
+	OP_LH = 0x21,
+	OP_LW = 0x23,
+	OP_LBU = 0x24,
+	OP_LHU = 0x25,
+	OP_LWU = 0x27,
+	OP_LD = 0x37,
+};
+
+enum OP_SPECIAL
+{
+	OP_SPECIAL_SLL = 0x00,
+	OP_SPECIAL_SRL = 0x02,
+	OP_SPECIAL_SRA = 0x03,
+	OP_SPECIAL_SLLV = 0x04,
+	OP_SPECIAL_SRLV = 0x06,
+	OP_SPECIAL_SRAV = 0x07,
+	OP_SPECIAL_SYNC = 0x0F,
+	OP_SPECIAL_ADDU = 0x21,
+	OP_SPECIAL_SUBU = 0x23,
+	OP_SPECIAL_AND = 0x24,
+	OP_SPECIAL_OR = 0x25,
+	OP_SPECIAL_XOR = 0x26,
+	OP_SPECIAL_NOR = 0x27,
+	OP_SPECIAL_SLT = 0x2A,
+	OP_SPECIAL_SLTU = 0x2B,
+	OP_SPECIAL_DADDU = 0x2D,
+};
+
+enum OP_REGIMM
+{
+	OP_REGIMM_BLTZ = 0x00,
+	OP_REGIMM_BGEZ = 0x01,
+};
+
+//Reading these doesn't change the state of their device
+static const uint32 g_ee_pollableRegisters[] =
+    {
+        0x10003020, //GIF_STAT
+        0x10003800, //VIF0_STAT
+        0x10003C00, //VIF1_STAT
+        0x1000E010, //D_STAT
+        0x1000F000, //INTC_STAT
+        0x12001000, //GS_CSR (VSync flag)
+};
+
+static const uint32 g_iop_pollableRegisters[] =
+    {
+        0x1F801070, //INTC STATUS0
+        0x1F8010F4, //DMAC DICR
+};
+
+//Loads from anything else (ie.: FIFOs) might have side effects, a loop reading them isn't idle
+static bool IsPollableAddress(IdleLoopAnalysis::ISA isa, uint32 address)
+{
+	const uint32* registersBegin = nullptr;
+	const uint32* registersEnd = nullptr;
+	if(isa == IdleLoopAnalysis::ISA_R5900)
+	{
+		//Scratchpad
+		if((address & 0xF0000000) == 0x70000000) return true;
+		//RAM, including uncached and uncached accelerated mirrors
+		uint32 segment = address >> 28;
+		uint32 physicalAddress = ((segment == 2) || (segment == 3)) ? (address & 0x0FFFFFFF) : (address & 0x1FFFFFFF);
+		if(physicalAddress < PS2::EE_RAM_SIZE) return true;
+		registersBegin = std::begin(g_ee_pollableRegisters);
+		registersEnd = std::end(g_ee_pollableRegisters);
+		address = physicalAddress;
+	}
+	else
+	{
+		uint32 physicalAddress = address & 0x1FFFFFFF;
+		if(physicalAddress < PS2::IOP_RAM_SIZE) return true;
+		if((physicalAddress >= PS2::IOP_SCRATCH_ADDR) && (physicalAddress < (PS2::IOP_SCRATCH_ADDR + PS2::IOP_SCRATCH_SIZE))) return true;
+		registersBegin = std::begin(g_iop_pollableRegisters);
+		registersEnd = std::end(g_iop_pollableRegisters);
+		address = physicalAddress;
+	}
+	return std::find(registersBegin, registersEnd, address) != registersEnd;
+}
+
+static bool IsR5900Instruction(uint32 op, uint32 special)
+{
+	switch(op)
+	{
+	case OP_DADDIU:
+	case OP_LQ:
+	case OP_LWU:
+	case OP_LD:
+		return true;
+	case OP_SPECIAL:
+		return (special == OP_SPECIAL_DADDU);
+	default:
+		return false;
+	}
+}
+
+uint32 IdleLoopAnalysis::GetIdleLoopHead(CMIPS& context, uint32 begin, uint32 end, ISA isa)
+{
+	if(begin == end) return MIPS_INVALID_PC;
+
+	uint32 endInstructionAddress = end - 4;
+	uint32 endInstruction = context.m_pMemoryMap->GetInstruction(endInstructionAddress);
+
+	//We need a branch at the end of the block
+	auto branchType = context.m_pArch->IsInstructionBranch(&context, endInstructionAddress, endInstruction);
+	if(branchType != MIPS_BRANCH_NORMAL) return MIPS_INVALID_PC;
+
+	//Check that the branch goes back to this block or to a block right before it
+	uint32 loopHead = context.m_pArch->GetInstructionEffectiveAddress(&context, endInstructionAddress, endInstruction);
+	if(loopHead == MIPS_INVALID_PC) return MIPS_INVALID_PC;
+	if(loopHead > begin) return MIPS_INVALID_PC;
+	if((end - loopHead) > g_maxLoopSize) return MIPS_INVALID_PC;
+
+	uint32 defState = 0;   //Registers defined on every path since the loop head
+	uint32 maybeState = 0; //Registers defined anywhere in the loop
+	uint32 useState = 0;   //Registers used before being defined on every path, value comes from a previous iteration
+	uint32 conditionalEnd = 0;
+	uint32 pendingConditionalEnd = 0;
+
+	//Values of registers computed from constants inside the loop (LUI/ADDIU/ORI), used to resolve load addresses
+	uint32 constantState = 1; //R0 is always 0
+	uint32 constantValues[32] = {};
+
+	//Check all instructions inside to see if we can prove that the loop doesn't change
+	//anything and that every iteration computes the same result given the same memory state
+	for(uint32 address = loopHead; address <= end; address += 4)
+	{
+		uint32 inst = context.m_pMemoryMap->GetInstruction(address);
+		uint32 special = inst & 0x3F;
+		uint32 rd = (inst >> 11) & 0x1F;
+		uint32 rt = (inst >> 16) & 0x1F;
+		uint32 rs = (inst >> 21) & 0x1F;
+		uint32 op = (inst >> 26) & 0x3F;
+
+		uint32 newDef = 0;
+		uint32 newUse = 0;
+		bool isBranch = false;
+		uint32 imm = inst & 0xFFFF;
+
+		if((isa != ISA_R5900) && IsR5900Instruction(op, special)) return MIPS_INVALID_PC;
+
+		//Constant tracking, result is only known if the instruction is executed on every iteration
+		bool isConstantDef = false;
+		uint32 constantValue = 0;
+
+		switch(op)
+		{
+		case OP_SPECIAL:
+			switch(special)
+			{
+			case OP_SPECIAL_SLL:
+			case OP_SPECIAL_SRL:
+			case OP_SPECIAL_SRA:
+				newUse = (1 << rt);
+				newDef = (1 << rd);
+				break;
+			case OP_SPECIAL_SLLV:
+			case OP_SPECIAL_SRLV:
+			case OP_SPECIAL_SRAV:
+			case OP_SPECIAL_ADDU:
+			case OP_SPECIAL_SUBU:
+			case OP_SPECIAL_AND:
+			case OP_SPECIAL_OR:
+			case OP_SPECIAL_XOR:
+			case OP_SPECIAL_NOR:
+			case OP_SPECIAL_SLT:
+			case OP_SPECIAL_SLTU:
+			case OP_SPECIAL_DADDU:
+				newUse = (1 << rs) | (1 << rt);
+				newDef = (1 << rd);
+				break;
+			case OP_SPECIAL_SYNC:
+				break;
+			default:
+				//We don't know what this does, let's not take a chance
+				return MIPS_INVALID_PC;
+			}
+			break;
+		case OP_REGIMM:
+			if((rt != OP_REGIMM_BLTZ) && (rt != OP_REGIMM_BGEZ)) return MIPS_INVALID_PC;
+			newUse = (1 << rs);
+			isBranch = true;
+			break;
+		case OP_BEQ:
+		case OP_BNE:
+			newUse = (1 << rs) | (1 << rt);
+			isBranch = true;
+			break;
+		case OP_BLEZ:
+		case OP_BGTZ:
+			newUse = (1 << rs);
+			isBranch = true;
+			break;
+		case OP_LUI:
+			newDef = (1 << rt);
+			isConstantDef = true;
+			constantValue = imm << 16;
+			break;
+		case OP_ADDIU:
+		case OP_ORI:
+			newUse = (1 << rs);
+			newDef = (1 << rt);
+			if(constantState & (1 << rs))
+			{
+				isConstantDef = true;
+				constantValue = (op == OP_ADDIU) ? (constantValues[rs] + static_cast<int16>(imm)) : (constantValues[rs] | imm);
+			}
+			break;
+		case OP_SLTI:
+		case OP_SLTIU:
+		case OP_ANDI:
+		case OP_XORI:
+		case OP_DADDIU:
+			newUse = (1 << rs);
+			newDef = (1 << rt);
+			break;
+		case OP_LQ:
+		case OP_LB:
+		case OP_LH:
+		case OP_LW:
+		case OP_LBU:
+		case OP_LHU:
+		case OP_LWU:
+		case OP_LD:
+		{
+			//Base needs to be known to make sure we're not reading from something that has side effects.
+			//GP and SP always point to RAM.
+			bool isPollable = (rs == CMIPS::GP) || (rs == CMIPS::SP) ||
+			                  ((constantState & (1 << rs)) && IsPollableAddress(isa, constantValues[rs] + static_cast<int16>(imm)));
+			if(!isPollable) return MIPS_INVALID_PC;
+			newUse = (1 << rs);
+			newDef = (1 << rt);
+		}
+		break;
+		default:
+			//We don't know what this does, let's not take a chance
+			return MIPS_INVALID_PC;
+		}
+
+		//R0 is never really defined
+		newDef &= ~1;
+
+		if(newDef != 0)
+		{
+			if(isConstantDef && (address >= conditionalEnd))
+			{
+				constantState |= newDef;
+				constantValues[rt] = constantValue;
+			}
+			else
+			{
+				constantState &= ~newDef;
+			}
+		}
+
+		if(isBranch)
+		{
+			//Branches can't be in delay slots
+			if(pendingConditionalEnd != 0) return MIPS_INVALID_PC;
+			if(address != endInstructionAddress)
+			{
+				uint32 target = context.m_pArch->GetInstructionEffectiveAddress(&context, address, inst);
+				if((target >= loopHead) && (target <= end))
+				{
+					//Only allow forward branches inside the loop, everything between the delay slot
+					//and the target might not be executed on every iteration
+					if(target <= address) return MIPS_INVALID_PC;
+					pendingConditionalEnd = std::max<uint32>(target, address + 8);
+				}
+				//Branches going outside of the loop are exit conditions
+			}
+		}
+
+		//Remove uses from defs within this iteration
+		useState |= (newUse & ~defState);
+
+		if(address < conditionalEnd)
+		{
+			maybeState |= newDef;
+		}
+		else
+		{
+			defState |= newDef;
+			maybeState |= newDef;
+		}
+
+		if(pendingConditionalEnd != 0 && !isBranch)
+		{
+			//Delay slot is done, following instructions are conditional
+			conditionalEnd = std::max(conditionalEnd, pendingConditionalEnd);
+			pendingConditionalEnd = 0;
+		}
+	}
+
+	//Bail if we use a value that was defined by a previous iteration
+	if(useState & maybeState) return MIPS_INVALID_PC;
+
+	return loopHead;
+}
+
+void IdleLoopAnalysis::CompileIdleLoopCheck(CMipsJitter* jitter, uint32 loopHead)
+{
+	jitter->PushRel(offsetof(CMIPS, m_State.nDelayedJumpAddr));
+	jitter->PushCst(loopHead);
+	jitter->BeginIf(Jitter::CONDITION_EQ);
+	{
+		//Don't override exceptions raised inside the block (ie.: TLB miss on a load)
+		jitter->PushRel(offsetof(CMIPS, m_State.nHasException));
+		jitter->PushCst(MIPS_EXCEPTION_NONE);
+		jitter->BeginIf(Jitter::CONDITION_EQ);
+		{
+			jitter->PushCst(MIPS_EXCEPTION_IDLE);
+			jitter->PullRel(offsetof(CMIPS, m_State.nHasException));
+		}
+		jitter->EndIf();
+	}
+	jitter->EndIf();
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Types.h"
+
+class CMIPS;
+class CMipsJitter;
+
+//Detects loops that only poll memory or registers without side effects (ie.: waiting
+//on a device status register or on a flag set by an interrupt handler). Such loops
+//can't make any progress until something outside of the CPU changes state.
+namespace IdleLoopAnalysis
+{
+	//Decides which instructions are valid and which addresses can be polled safely
+	enum ISA
+	{
+		ISA_R3000,
+		ISA_R5900,
+	};
+
+	//Returns the head of the loop closed by the branch ending the block at [begin, end]
+	//if that loop is an idle loop, MIPS_INVALID_PC otherwise.
+	uint32 GetIdleLoopHead(CMIPS&, uint32, uint32, ISA);
+
+	//Raises MIPS_EXCEPTION_IDLE if the block is branching back to the loop head.
+	void CompileIdleLoopCheck(CMipsJitter*, uint32);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+//Bounded key/value cache that evicts the least recently used item when full
+template <typename KeyType, typename ValueType>
+class CLruCache
+{
+public:
+	explicit CLruCache(size_t capacity)
+	    : m_capacity(capacity)
+	{
+		assert(m_capacity != 0);
+	}
+
+	//Returns null if key is not present, otherwise marks the item as most recently used
+	ValueType* Find(const KeyType& key)
+	{
+		auto itemIterator = m_itemMap.find(key);
+		if(itemIterator == std::end(m_itemMap))
+		{
+			return nullptr;
+		}
+		m_items.splice(std::begin(m_items), m_items, itemIterator->second);
+		return &itemIterator->second->second;
+	}
+
+	bool Contains(const KeyType& key) const
+	{
+		return m_itemMap.find(key) != std::end(m_itemMap);
+	}
+
+	ValueType& Insert(const KeyType& key, ValueType value)
+	{
+		auto itemIterator = m_itemMap.find(key);
+		if(itemIterator != std::end(m_itemMap))
+		{
+			m_items.erase(itemIterator->second);
+			m_itemMap.erase(itemIterator);
+		}
+		if(m_items.size() == m_capacity)
+		{
+			m_itemMap.erase(m_items.back().first);
+			m_items.pop_back();
+		}
+		m_items.emplace_front(key, std::move(value));
+		m_itemMap.emplace(key, std::begin(m_items));
+		return m_items.front().second;
+	}
+
+	void Clear()
+	{
+		m_items.clear();
+		m_itemMap.clear();
+	}
+
+	size_t GetSize() const
+	{
+		return m_items.size();
+	}
+
+	size_t GetCapacity() const
+	{
+		return m_capacity;
+	}
+
+private:
+	typedef std::list<std::pair<KeyType, ValueType>> ItemList;
+	typedef std::unordered_map<KeyType, typename ItemList::iterator> ItemMap;
+
+	size_t m_capacity = 0;
+	ItemList m_items;
+	ItemMap m_itemMap;
+};
@@ -766,6 +766,17 @@ void CMA_MIPSIV::LD()
 	if(!Ensure64BitRegs()) return;
 	if(m_nRT == 0) return;
 
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(8);
+
+		m_codeGen->Load64FromRefIdx(1);
+		m_codeGen->PullRel64(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		m_codeGen->Else();
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -788,6 +799,11 @@ void CMA_MIPSIV::LD()
 		m_codeGen->PullTop();
 	}
 	m_codeGen->EndIf();
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 //39
@@ -821,6 +837,17 @@ void CMA_MIPSIV::SD()
 {
 	if(!Ensure64BitRegs()) return;
 
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(8);
+
+		m_codeGen->PushRel64(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		m_codeGen->Store64AtRefIdx(1);
+		m_codeGen->Else();
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -843,6 +870,11 @@ void CMA_MIPSIV::SD()
 		m_codeGen->PullTop();
 	}
 	m_codeGen->EndIf();
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 //////////////////////////////////////////////////
@@ -94,6 +94,16 @@ void CMA_MIPSIV::Template_Load32Idx(const MemoryAccessIdxTraits& traits)
 		    m_codeGen->PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
 	    };
 
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(traits.elementSize);
+		((m_codeGen)->*(traits.loadFunction))(1);
+		finishLoad();
+		m_codeGen->Else();
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -127,12 +137,28 @@ void CMA_MIPSIV::Template_Load32Idx(const MemoryAccessIdxTraits& traits)
 	{
 		m_codeGen->EndIf();
 	}
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 void CMA_MIPSIV::Template_Store32Idx(const MemoryAccessIdxTraits& traits)
 {
 	CheckTLBExceptions(true);
 
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(traits.elementSize);
+
+		m_codeGen->PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT].nV[0]));
+		((m_codeGen)->*(traits.storeFunction))(1);
+		m_codeGen->Else();
+	}
+
 	bool usePageLookup = (m_pCtx->m_pageLookup != nullptr);
 
 	if(usePageLookup)
@@ -166,6 +192,11 @@ void CMA_MIPSIV::Template_Store32Idx(const MemoryAccessIdxTraits& traits)
 	{
 		m_codeGen->EndIf();
 	}
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 void CMA_MIPSIV::Template_ShiftCst32(const TemplateParamedOperationFunctionType& Function)
@@ -160,3 +160,12 @@ void CMIPS::MapPages(uint32 vAddress, uint32 size, uint8* memory)
 		m_pageLookup[pageBase + pageIndex] = memory + (MIPS_PAGE_SIZE * pageIndex);
 	}
 }
+
+void CMIPS::SetFastMemWindow(uint8* memory, uint32 size)
+{
+	//Addresses in [0, size) will be accessed directly at memory + address by compiled code.
+	//Executor needs to be reset for this to be taken into account by already compiled blocks.
+	assert((memory == nullptr) || ((size != 0) && ((size & (size - 1)) == 0)));
+	m_fastMemBase = memory;
+	m_fastMemSize = (memory != nullptr) ? size : 0;
+}
@@ -160,11 +160,14 @@ public:
 	bool GenerateException(uint32);
 
 	void MapPages(uint32, uint32, uint8*);
+	void SetFastMemWindow(uint8*, uint32);
 
 	MIPSSTATE m_State;
 
 	void* m_vuMem = nullptr;
 	void** m_pageLookup = nullptr;
+	uint8* m_fastMemBase = nullptr;
+	uint32 m_fastMemSize = 0;
 
 	std::function<void(CMIPS*)> m_emptyBlockHandler;
 
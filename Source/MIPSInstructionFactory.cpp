@@ -166,6 +166,30 @@ void CMIPSInstructionFactory::ComputeMemAccessPageRef()
 	m_codeGen->LoadRefFromRefIdx();
 }
 
+void CMIPSInstructionFactory::ComputeMemAccessFastRefIdx(uint32 accessSize)
+{
+	assert(m_pCtx->m_fastMemBase);
+
+	m_codeGen->PushRelRef(offsetof(CMIPS, m_fastMemBase));
+
+	ComputeMemAccessAddrNoXlat();
+	m_codeGen->PushCst(m_pCtx->m_fastMemSize - accessSize);
+	m_codeGen->And();
+}
+
+bool CMIPSInstructionFactory::BeginFastMemAccess()
+{
+	//If a fast memory window is available, emits a range check on the address
+	//and opens a block that is executed when the access falls inside the window.
+	//Caller must emit the fallback access after Else and close the block with EndIf.
+	if(m_pCtx->m_fastMemBase == nullptr) return false;
+
+	ComputeMemAccessAddrNoXlat();
+	m_codeGen->PushCst(m_pCtx->m_fastMemSize);
+	m_codeGen->BeginIf(Jitter::CONDITION_BL);
+	return true;
+}
+
 void CMIPSInstructionFactory::Branch(Jitter::CONDITION condition)
 {
 	uint16 nImmediate = (uint16)(m_nOpcode & 0xFFFF);
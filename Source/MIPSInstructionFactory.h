@@ -32,6 +32,8 @@ protected:
 	void ComputeMemAccessRef(uint32);
 	void ComputeMemAccessRefIdx(uint32);
 	void ComputeMemAccessPageRef();
+	void ComputeMemAccessFastRefIdx(uint32);
+	bool BeginFastMemAccess();
 
 	void CheckTLBExceptions(bool);
 	void CheckTrap();
@@ -36,6 +36,7 @@
 #define LOG_NAME ("ps2vm")
 
 #define THREAD_NAME ("PS2VM Thread")
+#define IOP_THREAD_NAME ("PS2VM IOP Thread")
 
 #define STATE_VM_TIMING_XML ("vm_timing.xml")
 #define STATE_VM_TIMING_VBLANK_TICKS ("vblankTicks")
@@ -91,6 +92,10 @@ CPS2VM::CPS2VM()
 	Framework::PathUtils::EnsurePathExists(GetStateDirectoryPath());
 
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_LIMIT_FRAMERATE, true);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_ADAPTIVE_TIMESLICE, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_THREADED_IOP, false);
+	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_PS2_THREADED_IOP_MAX_SKEW, m_eeTickStep * 8);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_PS2_FASTMEM, false);
 	ReloadFrameRateLimit();
 
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_AUDIO_SPUBLOCKCOUNT, 100);
@@ -237,9 +242,11 @@ void CPS2VM::ReloadFrameRateLimit()
 	bool limitFrameRate = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_LIMIT_FRAMERATE);
 	m_frameLimiter.SetFrameRate(limitFrameRate ? vRefreshRate : 0);
 
+	m_adaptiveTimeSlice = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_ADAPTIVE_TIMESLICE);
+
 	//At 1x scale, IOP runs 8 times slower than EE
 	uint32 eeFreqScaled = PS2::EE_CLOCK_FREQ * m_eeFreqScaleNumerator / m_eeFreqScaleDenominator;
-	m_iopTickStep = (m_eeTickStep / 8) * m_eeFreqScaleDenominator / m_eeFreqScaleNumerator;
+	m_iopTickStep = GetIopTickStep(m_eeTickStep);
 
 	m_hblankTicksTotal = eeFreqScaled / hRefreshRate;
 
@@ -489,6 +496,11 @@ void CPS2VM::ResetVM()
 	m_ee->Reset(m_eeRamSize);
 	m_iop->Reset();
 
+	//Let compiled code access main RAM directly, other regions still go through the page table
+	bool fastMem = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_FASTMEM);
+	m_ee->m_EE.SetFastMemWindow(fastMem ? m_ee->m_ram : nullptr, PS2::EE_RAM_SIZE);
+	m_iop->m_cpu.SetFastMemWindow(fastMem ? m_iop->m_ram : nullptr, PS2::IOP_RAM_SIZE);
+
 	if(m_ee->m_gs != NULL)
 	{
 		m_ee->m_gs->Reset();
@@ -748,6 +760,11 @@ void CPS2VM::UpdateIop()
 	CProfilerZone profilerZone(m_iopProfilerZone);
 #endif
 
+	ExecuteIop();
+}
+
+void CPS2VM::ExecuteIop()
+{
 	while(m_iopExecutionTicks > 0)
 	{
 		int executed = m_iop->ExecuteCpu(m_singleStepIop ? 1 : m_iopExecutionTicks);
@@ -768,6 +785,112 @@ void CPS2VM::UpdateIop()
 	}
 }
 
+int CPS2VM::GetIopTickStep(int eeTickStep) const
+{
+	return (eeTickStep / 8) * m_eeFreqScaleDenominator / m_eeFreqScaleNumerator;
+}
+
+int CPS2VM::GetAdaptiveEeTickStep()
+{
+	//Run until the next point where EE and IOP need to be in sync with the rest of the system
+	//(SPU update, hblank, vblank, device deadlines). Never go below the regular step.
+	int64 tickStep = m_maxEeTickStep;
+	tickStep = std::min<int64>(tickStep, m_hblankTicks);
+	tickStep = std::min<int64>(tickStep, m_vblankTicks);
+	tickStep = std::min<int64>(tickStep, m_spuUpdateTicks >> SPU_UPDATE_TICKS_PRECISION);
+	tickStep = std::min<int64>(tickStep, m_ee->GetTicksUntilNextEvent());
+	//When IOP runs on its own thread, its deadlines are handled there
+	uint32 iopTicks = m_threadedIop ? ~0U : m_iop->GetTicksUntilNextEvent();
+	if(iopTicks != ~0U)
+	{
+		int64 iopTicksInEeTicks = static_cast<int64>(iopTicks) * 8 * m_eeFreqScaleNumerator / m_eeFreqScaleDenominator;
+		tickStep = std::min<int64>(tickStep, iopTicksInEeTicks);
+	}
+	tickStep = std::max<int64>(tickStep, m_eeTickStep);
+	//Keep step a multiple of 8 to avoid losing IOP ticks to rounding
+	return static_cast<int>(tickStep) & ~0x07;
+}
+
+bool CPS2VM::IsSingleStepping() const
+{
+	return m_singleStepEe || m_singleStepIop || m_singleStepVu0 || m_singleStepVu1;
+}
+
+void CPS2VM::StartIopThread()
+{
+	assert(!m_iopThread.joinable());
+	m_iopMaxSkew = GetIopTickStep(CAppConfig::GetInstance().GetPreferenceInteger(PREF_PS2_THREADED_IOP_MAX_SKEW));
+	m_iopMaxSkew = std::max<int64>(m_iopMaxSkew, m_iopTickStep);
+	m_iopTicksGranted = 0;
+	m_iopTicksConsumed = 0;
+	m_iopThreadEnd = false;
+	m_ee->SetIopExchangeMutex(&m_iopExchangeMutex);
+	m_iopThread = std::thread([this]() { IopThreadProc(); });
+	Framework::ThreadUtils::SetThreadName(m_iopThread, IOP_THREAD_NAME);
+}
+
+void CPS2VM::StopIopThread()
+{
+	if(!m_iopThread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> threadLock(m_iopThreadMutex);
+		m_iopThreadEnd = true;
+	}
+	m_iopThreadCondition.notify_all();
+	m_iopThread.join();
+	m_ee->SetIopExchangeMutex(nullptr);
+}
+
+void CPS2VM::AdvanceIopThread(int iopTickStep)
+{
+	std::unique_lock<std::mutex> threadLock(m_iopThreadMutex);
+	//Don't let EE get further ahead of IOP than allowed
+	m_iopThreadCondition.wait(threadLock, [this]() { return (m_iopTicksGranted - m_iopTicksConsumed) <= m_iopMaxSkew; });
+	m_iopTicksGranted += iopTickStep;
+	threadLock.unlock();
+	m_iopThreadCondition.notify_all();
+}
+
+void CPS2VM::SyncIopThread()
+{
+	if(!m_iopThread.joinable()) return;
+	std::unique_lock<std::mutex> threadLock(m_iopThreadMutex);
+	m_iopThreadCondition.wait(threadLock, [this]() { return m_iopTicksConsumed >= m_iopTicksGranted; });
+}
+
+std::unique_lock<std::recursive_mutex> CPS2VM::LockIopExchange()
+{
+	if(!m_threadedIop) return std::unique_lock<std::recursive_mutex>();
+	return std::unique_lock<std::recursive_mutex>(m_iopExchangeMutex);
+}
+
+void CPS2VM::IopThreadProc()
+{
+	fesetround(FE_TOWARDZERO);
+	FpUtils::SetDenormalHandlingMode();
+	while(1)
+	{
+		int tickStep = 0;
+		{
+			std::unique_lock<std::mutex> threadLock(m_iopThreadMutex);
+			m_iopThreadCondition.wait(threadLock, [this]() { return m_iopThreadEnd || (m_iopTicksConsumed < m_iopTicksGranted); });
+			if(m_iopThreadEnd) break;
+			tickStep = static_cast<int>(std::min<int64>(m_iopTicksGranted - m_iopTicksConsumed, m_iopTickStep));
+		}
+		{
+			//Run in small chunks to give EE a chance to go through SIF
+			std::lock_guard<std::recursive_mutex> exchangeLock(m_iopExchangeMutex);
+			m_iopExecutionTicks += tickStep;
+			ExecuteIop();
+		}
+		{
+			std::lock_guard<std::mutex> threadLock(m_iopThreadMutex);
+			m_iopTicksConsumed += tickStep;
+		}
+		m_iopThreadCondition.notify_all();
+	}
+}
+
 void CPS2VM::UpdateSpu()
 {
 #ifdef PROFILE
@@ -894,11 +1017,20 @@ void CPS2VM::EmuThread()
 	CProfilerZone profilerZone(m_otherProfilerZone);
 #endif
 	static_cast<CEeExecutor*>(m_ee->m_EE.m_executor.get())->AddExceptionHandler();
+#ifndef DEBUGGER_INCLUDED
+	m_threadedIop = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_PS2_THREADED_IOP);
+#endif
+	if(m_threadedIop)
+	{
+		StartIopThread();
+	}
 	m_frameLimiter.BeginFrame();
 	while(1)
 	{
 		while(m_mailBox.IsPending())
 		{
+			//Calls might inspect or modify IOP state, make sure it's not running
+			SyncIopThread();
 			m_mailBox.ReceiveCall();
 		}
 		if(m_nEnd) break;
@@ -910,6 +1042,7 @@ void CPS2VM::EmuThread()
 		{
 			if(m_spuUpdateTicks <= 0)
 			{
+				auto exchangeLock = LockIopExchange();
 				UpdateSpu();
 				m_spuUpdateTicks += m_spuUpdateTicksTotal;
 			}
@@ -931,8 +1064,11 @@ void CPS2VM::EmuThread()
 					if(m_inVblank)
 					{
 						m_vblankTicks += m_vblankTicksTotal;
-						m_ee->NotifyVBlankStart();
-						m_iop->NotifyVBlankStart();
+						{
+							auto exchangeLock = LockIopExchange();
+							m_ee->NotifyVBlankStart();
+							m_iop->NotifyVBlankStart();
+						}
 
 						if(m_ee->m_gs != NULL)
 						{
@@ -944,6 +1080,7 @@ void CPS2VM::EmuThread()
 
 						if(m_pad != NULL)
 						{
+							auto exchangeLock = LockIopExchange();
 							m_pad->Update(m_ee->m_ram);
 						}
 #ifdef PROFILE
@@ -954,13 +1091,19 @@ void CPS2VM::EmuThread()
 #ifdef PROFILE
 						CProfiler::GetInstance().Reset();
 #endif
-						m_cpuUtilisation = CPU_UTILISATION_INFO();
+						{
+							auto exchangeLock = LockIopExchange();
+							m_cpuUtilisation = CPU_UTILISATION_INFO();
+						}
 					}
 					else
 					{
 						m_vblankTicks += m_onScreenTicksTotal;
-						m_ee->NotifyVBlankEnd();
-						m_iop->NotifyVBlankEnd();
+						{
+							auto exchangeLock = LockIopExchange();
+							m_ee->NotifyVBlankEnd();
+							m_iop->NotifyVBlankEnd();
+						}
 						if(m_ee->m_gs != NULL)
 						{
 							m_ee->m_gs->ResetVBlank();
@@ -970,11 +1113,27 @@ void CPS2VM::EmuThread()
 					}
 				}
 
-				m_eeExecutionTicks += m_eeTickStep;
-				m_iopExecutionTicks += m_iopTickStep;
+				int eeTickStep = m_eeTickStep;
+				int iopTickStep = m_iopTickStep;
+				if(m_adaptiveTimeSlice && !IsSingleStepping())
+				{
+					eeTickStep = GetAdaptiveEeTickStep();
+					iopTickStep = GetIopTickStep(eeTickStep);
+				}
 
-				UpdateEe();
-				UpdateIop();
+				m_eeExecutionTicks += eeTickStep;
+				if(m_threadedIop && !IsSingleStepping())
+				{
+					AdvanceIopThread(iopTickStep);
+					UpdateEe();
+				}
+				else
+				{
+					SyncIopThread();
+					m_iopExecutionTicks += iopTickStep;
+					UpdateEe();
+					UpdateIop();
+				}
 			}
 #ifdef DEBUGGER_INCLUDED
 			if(
@@ -994,6 +1153,7 @@ void CPS2VM::EmuThread()
 #endif
 		}
 	}
+	StopIopThread();
 	static_cast<CEeExecutor*>(m_ee->m_EE.m_executor.get())->RemoveExceptionHandler();
 #ifdef __ANDROID__
 	Framework::CJavaVM::DetachCurrentThread();
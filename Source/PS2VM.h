@@ -2,6 +2,8 @@
 
 #include <thread>
 #include <future>
+#include <mutex>
+#include <condition_variable>
 #include "filesystem_def.h"
 #include "Types.h"
 #include "MIPS.h"
@@ -141,8 +143,20 @@ private:
 
 	void UpdateEe();
 	void UpdateIop();
+	void ExecuteIop();
 	void UpdateSpu();
 
+	int GetIopTickStep(int) const;
+	int GetAdaptiveEeTickStep();
+	bool IsSingleStepping() const;
+
+	void StartIopThread();
+	void StopIopThread();
+	void AdvanceIopThread(int);
+	void SyncIopThread();
+	std::unique_lock<std::recursive_mutex> LockIopExchange();
+	void IopThreadProc();
+
 	void SetIopOpticalMedia(COpticalMedia*);
 
 	void RegisterModulesInPadHandler();
@@ -168,7 +182,21 @@ private:
 	int m_eeExecutionTicks = 0;
 	int m_iopExecutionTicks = 0;
 	static const int m_eeTickStep = 4800;
+	static const int m_maxEeTickStep = 4800 * 16;
 	int m_iopTickStep = 0;
+	bool m_adaptiveTimeSlice = false;
+
+	//Threaded IOP mode: IOP runs on its own thread and is allowed to lag behind EE by at most m_iopMaxSkew IOP ticks.
+	//m_iopExchangeMutex is held by the IOP thread while it executes and by the EE side when touching shared state.
+	bool m_threadedIop = false;
+	bool m_iopThreadEnd = false;
+	int64 m_iopMaxSkew = 0;
+	int64 m_iopTicksGranted = 0;
+	int64 m_iopTicksConsumed = 0;
+	std::thread m_iopThread;
+	std::mutex m_iopThreadMutex;
+	std::condition_variable m_iopThreadCondition;
+	std::recursive_mutex m_iopExchangeMutex;
 	CFrameLimiter m_frameLimiter;
 
 	CPU_UTILISATION_INFO m_cpuUtilisation;
@@ -13,6 +13,10 @@
 #define PREF_PS2_ARCADE_IO_SERVER_PORT ("ps2.arcade.ioserver.port")
 
 #define PREF_PS2_LIMIT_FRAMERATE ("ps2.limitframerate")
+#define PREF_PS2_ADAPTIVE_TIMESLICE ("ps2.adaptivetimeslice")
+#define PREF_PS2_THREADED_IOP ("ps2.threadediop")
+#define PREF_PS2_THREADED_IOP_MAX_SKEW ("ps2.threadediop.maxskew")
+#define PREF_PS2_FASTMEM ("ps2.fastmem")
 
 #define PREF_AUDIO_SPUBLOCKCOUNT ("audio.spublockcount")
 
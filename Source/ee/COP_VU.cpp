@@ -80,6 +80,17 @@ void CCOP_VU::LQC2()
 {
 	if(m_nFT == 0) return;
 
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(0x10);
+
+		m_codeGen->MD_LoadFromRefIdx(1);
+		m_codeGen->MD_PullRel(offsetof(CMIPS, m_State.nCOP2[m_nFT]));
+		m_codeGen->Else();
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -109,11 +120,27 @@ void CCOP_VU::LQC2()
 		}
 	}
 	m_codeGen->EndIf();
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 //3E
 void CCOP_VU::SQC2()
 {
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(0x10);
+
+		m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nCOP2[m_nFT]));
+		m_codeGen->MD_StoreAtRefIdx(1);
+		m_codeGen->Else();
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -143,6 +170,11 @@ void CCOP_VU::SQC2()
 		}
 	}
 	m_codeGen->EndIf();
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 //////////////////////////////////////////////////
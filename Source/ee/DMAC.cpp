@@ -244,6 +244,13 @@ bool CDMAC::IsDMA4Started() const
 	return (m_D4.m_CHCR.nSTR != 0) && ((m_D_ENABLE & CDMAC::ENABLE_CPND) == 0);
 }
 
+bool CDMAC::IsResumableDMAStarted() const
+{
+	//Channels that need to be resumed periodically (ResumeDMA0/1/2/8)
+	return (m_D0.m_CHCR.nSTR != 0) || (m_D1.m_CHCR.nSTR != 0) ||
+	       (m_D2.m_CHCR.nSTR != 0) || (m_D8.m_CHCR.nSTR != 0);
+}
+
 uint64 CDMAC::FetchDMATag(uint32 address)
 {
 	if(address & 0x80000000)
@@ -131,6 +131,7 @@ public:
 	void ResumeDMA4();
 	void ResumeDMA8();
 	bool IsDMA4Started() const;
+	bool IsResumableDMAStarted() const;
 	static bool IsEndSrcTagId(uint32);
 	static bool IsEndDstTagId(uint32);
 
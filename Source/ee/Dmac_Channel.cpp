@@ -276,6 +276,9 @@ void CChannel::ExecuteSourceChain()
 		break;
 	}
 
+	//Data from consecutive tags can be sent to the device in one go if it doesn't need to see the tags
+	bool canMergeTransfers = !isMfifo && !isStallDrainChannel && (m_CHCR.nTTE == 0);
+
 	//Pause transfer if channel is stalled
 	if(isStallDrainChannel && ((m_CHCR.nTAG & DMATAG_ID) == (DMATAG_SRC_REFS << 12)) && (m_nMADR >= m_dmac.m_D_STADR))
 	{
@@ -453,7 +456,14 @@ void CChannel::ExecuteSourceChain()
 			continue;
 		}
 
-		ExecuteSourceChainTransfer(isMfifo);
+		if(canMergeTransfers && IsMergeableSrcTagId(nID))
+		{
+			ExecuteMergedSourceChainTransfer();
+		}
+		else
+		{
+			ExecuteSourceChainTransfer(isMfifo);
+		}
 	}
 }
 
@@ -561,6 +571,104 @@ void CChannel::ExecuteSourceChainTransfer(bool isMfifo)
 	}
 }
 
+void CChannel::ExecuteMergedSourceChainTransfer()
+{
+	//Walk the following tags as long as their data is adjacent to the data we're about to transfer
+	MERGED_TAG mergedTags[MAX_MERGED_TAGS];
+	unsigned int mergedTagCount = 0;
+	uint32 startAddress = m_nMADR;
+	uint32 totalQwc = m_nQWC;
+	mergedTags[mergedTagCount++] = {m_nQWC, m_nTADR, m_CHCR.nTAG};
+
+	while(mergedTagCount < MAX_MERGED_TAGS)
+	{
+		const auto& prevTag = mergedTags[mergedTagCount - 1];
+
+		//Don't go past a tag that would stop the transfer
+		if(CDMAC::IsEndSrcTagId(prevTag.tag)) break;
+		if((m_CHCR.nTIE != 0) && ((prevTag.tag & DMATAG_IRQ) != 0)) break;
+		if(prevTag.nextTadr == 0) break;
+
+		uint64 nTag = m_dmac.FetchDMATag(prevTag.nextTadr);
+		uint32 nID = static_cast<uint32>((nTag >> 28) & 0x07);
+		if(!IsMergeableSrcTagId(nID)) break;
+
+		uint32 madr = 0;
+		uint32 qwc = static_cast<uint32>(nTag & 0xFFFF);
+		uint32 nextTadr = 0;
+		switch(nID)
+		{
+		case DMATAG_SRC_REFE:
+		case DMATAG_SRC_REF:
+			madr = static_cast<uint32>((nTag >> 32) & DMATAG_ADDR_MASK);
+			nextTadr = prevTag.nextTadr + 0x10;
+			break;
+		case DMATAG_SRC_CNT:
+			madr = prevTag.nextTadr + 0x10;
+			nextTadr = madr + (qwc * 0x10);
+			break;
+		case DMATAG_SRC_NEXT:
+			madr = prevTag.nextTadr + 0x10;
+			nextTadr = static_cast<uint32>((nTag >> 32) & DMATAG_ADDR_MASK);
+			break;
+		case DMATAG_SRC_END:
+			madr = prevTag.nextTadr + 0x10;
+			nextTadr = prevTag.nextTadr;
+			break;
+		}
+
+		if(madr != (startAddress + (totalQwc * 0x10))) break;
+
+		mergedTags[mergedTagCount++] = {qwc, nextTadr, static_cast<uint16>(nTag >> 16)};
+		totalQwc += qwc;
+	}
+
+	if(mergedTagCount == 1)
+	{
+		ExecuteSourceChainTransfer(false);
+		return;
+	}
+
+	uint32 recv = (totalQwc != 0) ? m_receive(startAddress, totalQwc, CHCR_DIR_FROM, false) : 0;
+
+	//Leave the channel in the state it would be in if the tags were processed one by one
+	uint32 tagAddress = startAddress;
+	for(unsigned int i = 0; i < mergedTagCount; i++)
+	{
+		const auto& mergedTag = mergedTags[i];
+		uint32 tagRecv = std::min<uint32>(recv, mergedTag.qwc);
+		recv -= tagRecv;
+
+		m_CHCR.nTAG = mergedTag.tag;
+		m_nMADR = tagAddress + (tagRecv * 0x10);
+		m_nQWC = mergedTag.qwc - tagRecv;
+		m_nTADR = mergedTag.nextTadr;
+
+		if(m_nQWC != 0)
+		{
+			//Device stopped in the middle of this tag's data
+			break;
+		}
+		tagAddress += mergedTag.qwc * 0x10;
+	}
+}
+
+bool CChannel::IsMergeableSrcTagId(uint32 id)
+{
+	//REFS is subject to stall control and CALL/RET change the address stack
+	switch(id)
+	{
+	case DMATAG_SRC_REFE:
+	case DMATAG_SRC_CNT:
+	case DMATAG_SRC_NEXT:
+	case DMATAG_SRC_REF:
+	case DMATAG_SRC_END:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void CChannel::ClearSTR()
 {
 	m_CHCR.nSTR = ~m_CHCR.nSTR;
@@ -93,7 +93,21 @@ namespace Dmac
 			SCCTRL_INITXFER = 0x200,
 		};
 
+		enum
+		{
+			MAX_MERGED_TAGS = 64,
+		};
+
+		struct MERGED_TAG
+		{
+			uint32 qwc;
+			uint32 nextTadr;
+			uint16 tag;
+		};
+
 		void ExecuteSourceChainTransfer(bool);
+		void ExecuteMergedSourceChainTransfer();
+		static bool IsMergeableSrcTagId(uint32);
 		void ClearSTR();
 
 		CDMAC& m_dmac;
@@ -9,7 +9,4 @@ public:
 
 protected:
 	void CompileEpilog(CMipsJitter*, bool) override;
-
-private:
-	bool IsIdleLoopBlock() const;
 };
@@ -44,6 +44,7 @@ void CEeExecutor::AddExceptionHandler()
 {
 	assert(g_eeExecutor == nullptr);
 	g_eeExecutor = this;
+	m_executingThreadId = std::this_thread::get_id();
 
 #ifdef DISABLE_PROTECTION
 	return;
@@ -107,9 +108,62 @@ void CEeExecutor::AttachExceptionHandlerToThread()
 #endif
 }
 
+CEeExecutor::ExternalWriteLock CEeExecutor::PrepareExternalWrite(uint32 address, uint32 size)
+{
+	//The access fault handler takes care of writes done by the executing thread
+	if(std::this_thread::get_id() == m_executingThreadId) return ExternalWriteLock();
+
+	ExternalWriteLock writeLock(m_externalWriteMutex);
+	address &= (PS2::EE_RAM_SIZE - 1);
+	uint32 end = std::min<uint32>(address + size, PS2::EE_RAM_SIZE);
+	if(address >= end) return writeLock;
+
+	uint32 pageStart = address & ~(m_pageSize - 1);
+	uint32 pageEnd = (end + m_pageSize - 1) & ~(m_pageSize - 1);
+	SetMemoryProtected(m_ram + pageStart, pageEnd - pageStart, false);
+	MarkExternalWrite(pageStart, pageEnd);
+	return writeLock;
+}
+
+void CEeExecutor::ProcessExternalWrites()
+{
+	if(!m_hasExternalWrites) return;
+	m_hasExternalWrites = false;
+
+	for(uint32 wordIndex = 0; wordIndex < EXTERNAL_WRITE_WORD_COUNT; wordIndex++)
+	{
+		uint32 pageBits = m_externalWritePages[wordIndex].exchange(0);
+		while(pageBits != 0)
+		{
+			uint32 bitIndex = __builtin_ctz(pageBits);
+			pageBits &= pageBits - 1;
+			uint32 pageStart = ((wordIndex * 32) + bitIndex) * EXTERNAL_WRITE_PAGE_SIZE;
+			ClearActiveBlocksInRange(pageStart, pageStart + EXTERNAL_WRITE_PAGE_SIZE, false);
+		}
+	}
+}
+
+void CEeExecutor::MarkExternalWrite(uint32 start, uint32 end)
+{
+	//This is called from the access fault handler, don't lock or allocate anything in here
+	assert(start < end);
+	assert(end <= PS2::EE_RAM_SIZE);
+	for(uint32 pageIndex = start / EXTERNAL_WRITE_PAGE_SIZE;
+	    pageIndex < (end + EXTERNAL_WRITE_PAGE_SIZE - 1) / EXTERNAL_WRITE_PAGE_SIZE; pageIndex++)
+	{
+		m_externalWritePages[pageIndex / 32].fetch_or(1U << (pageIndex % 32));
+	}
+	m_hasExternalWrites = true;
+}
+
 void CEeExecutor::Reset()
 {
 	SetMemoryProtected(m_ram, PS2::EE_RAM_SIZE, false);
+	for(auto& externalWritePages : m_externalWritePages)
+	{
+		externalWritePages = 0;
+	}
+	m_hasExternalWrites = false;
 	m_cachedBlocks.clear();
 	CGenericMipsExecutor::Reset();
 }
@@ -130,6 +184,8 @@ BasicBlockPtr CEeExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end
 	//so it keeps generating exceptions, making the game slower)
 	if(start >= 0x100000 && start < PS2::EE_RAM_SIZE)
 	{
+		//Don't protect pages while another thread is writing to them
+		std::lock_guard<std::mutex> writeLock(m_externalWriteMutex);
 		SetMemoryProtected(m_ram + start, blockSize, true);
 	}
 
@@ -184,6 +240,14 @@ bool CEeExecutor::HandleAccessFault(intptr_t ptr)
 	if(addr >= 0 && addr < PS2::EE_RAM_SIZE)
 	{
 		addr &= ~(m_pageSize - 1);
+		if(std::this_thread::get_id() != m_executingThreadId)
+		{
+			//Blocks can't be touched from this thread, let the executing thread invalidate them.
+			//Only do what's safe from a signal handler here: mprotect and lock-free atomics.
+			SetMemoryProtected(m_ram + addr, m_pageSize, false);
+			MarkExternalWrite(addr, addr + m_pageSize);
+			return true;
+		}
 		ClearActiveBlocksInRange(addr, addr + m_pageSize, true);
 		return true;
 	}
@@ -9,7 +9,11 @@
 #include <signal.h>
 #endif
 
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include "../GenericMipsExecutor.h"
+#include "../Ps2Const.h"
 
 class CEeExecutor : public CGenericMipsExecutor<BlockLookupTwoWay>
 {
@@ -22,6 +26,14 @@ public:
 
 	void AttachExceptionHandlerToThread();
 
+	//Blocks can only be invalidated by the executing thread. Writes to EE RAM done by other threads
+	//(ie.: threaded IOP) mark the pages they touch and ProcessExternalWrites invalidates them later.
+	//Pages are kept unprotected while the returned lock is held, writer threads might not be able to
+	//handle access faults (ie.: on macOS, where the handler is attached per thread).
+	typedef std::unique_lock<std::mutex> ExternalWriteLock;
+	ExternalWriteLock PrepareExternalWrite(uint32, uint32);
+	void ProcessExternalWrites();
+
 	void Reset() override;
 	void ClearActiveBlocksInRange(uint32, uint32, bool) override;
 
@@ -32,9 +44,25 @@ private:
 	typedef std::map<CachedBlockKey, BasicBlockPtr> CachedBlockMap;
 	CachedBlockMap m_cachedBlocks;
 
+	//Granularity of the external write bitmap, host pages are at least this big
+	enum
+	{
+		EXTERNAL_WRITE_PAGE_SIZE = 0x1000,
+		EXTERNAL_WRITE_PAGE_COUNT = PS2::EE_RAM_SIZE / EXTERNAL_WRITE_PAGE_SIZE,
+		EXTERNAL_WRITE_WORD_COUNT = EXTERNAL_WRITE_PAGE_COUNT / 32,
+	};
+
 	uint8* m_ram = nullptr;
 	size_t m_pageSize = 0;
 
+	std::thread::id m_executingThreadId;
+	//Only held by writers and while protecting pages, never by the access fault handler
+	std::mutex m_externalWriteMutex;
+	//Only updated with lock-free atomic operations, this is used from the access fault handler
+	std::atomic<uint32> m_externalWritePages[EXTERNAL_WRITE_WORD_COUNT] = {};
+	std::atomic<bool> m_hasExternalWrites = false;
+
+	void MarkExternalWrite(uint32, uint32);
 	bool HandleAccessFault(intptr_t);
 	void SetMemoryProtected(void*, size_t, bool);
 
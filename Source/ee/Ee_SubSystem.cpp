@@ -6,9 +6,11 @@
 #include "../Ps2Const.h"
 #include "../Log.h"
 #include "../states/MemoryStateFile.h"
+#include "../states/RegisterStateFile.h"
 #include "../iop/IopBios.h"
 #include "Vif.h"
 #include "placeholder_def.h"
+#include <iterator>
 
 using namespace Ee;
 
@@ -24,6 +26,23 @@ using namespace Ee;
 #define STATE_VUMEM1 ("vumem1")
 #define STATE_MICROMEM1 ("micromem1")
 
+#define STATE_EVENTS_XML ("ee_events.xml")
+#define STATE_EVENTS_SIF_DEFERRED_TICKS ("sifDeferredTicks")
+
+//Keys used to save event deadlines, these must not change when events are added or reordered
+// clang-format off
+static const char* g_eventStateNames[] =
+{
+	"dmaEventTicks",
+	"gifEventTicks",
+	"ipuEventTicks",
+	"vif0EventTicks",
+	"vif1EventTicks",
+	"sifEventTicks",
+	"timerEventTicks",
+};
+// clang-format on
+
 #define FAKE_IOP_RAM_SIZE (0x1000)
 
 CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
@@ -49,6 +68,7 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
     , m_COP_SCU(MIPS_REGSIZE_64)
     , m_COP_FPU(MIPS_REGSIZE_64)
     , m_COP_VU(MIPS_REGSIZE_64)
+    , m_eventScheduler(EVENT_COUNT)
 {
 	//Some alignment checks, this is needed because of SIMD instructions used in generated code
 	assert((reinterpret_cast<size_t>(&m_EE.m_State) & 0x0F) == 0);
@@ -104,7 +124,8 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 
 	//Vector Unit 0 context setup
 	{
-		m_VU0.m_executor = std::make_unique<CVuExecutor>(m_VU0, PS2::MICROMEM0SIZE);
+		//VU0 flags are visible to EE through macro mode
+		m_VU0.m_executor = std::make_unique<CVuExecutor>(m_VU0, PS2::MICROMEM0SIZE, true);
 
 		m_VU0.m_pMemoryMap->InsertReadMap(0x00000000, 0x00000FFF, m_vuMem0, 0x01);
 		m_VU0.m_pMemoryMap->InsertReadMap(0x00001000, 0x00001FFF, m_vuMem0, 0x02);
@@ -126,7 +147,8 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 
 	//Vector Unit 1 context setup
 	{
-		m_VU1.m_executor = std::make_unique<CVuExecutor>(m_VU1, PS2::MICROMEM1SIZE);
+		//VU1 flags can only be read by its own microprograms
+		m_VU1.m_executor = std::make_unique<CVuExecutor>(m_VU1, PS2::MICROMEM1SIZE, false);
 
 		m_VU1.m_pMemoryMap->InsertReadMap(0x00000000, 0x00003FFF, m_vuMem1, 0x00);
 		m_VU1.m_pMemoryMap->InsertReadMap(0x00008000, 0x00008FFF, std::bind(&CSubSystem::Vu1IoPortReadHandler, this, PLACEHOLDER_1), 0x01);
@@ -148,8 +170,20 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_VIF1, std::bind(&CVif::ReceiveDMA, &m_vpu1->GetVif(), PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_GIF, std::bind(&CGIF::ReceiveDMA, &m_gif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
 	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_TO_IPU, std::bind(&CIPU::ReceiveDMA4, &m_ipu, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_4, m_ram, m_spr));
-	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF0, std::bind(&CSIF::ReceiveDMA5, &m_sif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
-	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF1, std::bind(&CSIF::ReceiveDMA6, &m_sif, PLACEHOLDER_1, PLACEHOLDER_2, PLACEHOLDER_3, PLACEHOLDER_4));
+	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF0,
+	                                  [this](uint32 address, uint32 qwc, uint32 dstAddress, bool tagIncluded) {
+		                                  auto exchangeLock = LockIopExchange();
+		                                  return m_sif.ReceiveDMA5(address, qwc, dstAddress, tagIncluded);
+	                                  });
+	m_dmac.SetChannelTransferFunction(CDMAC::CHANNEL_ID_SIF1,
+	                                  [this](uint32 address, uint32 qwc, uint32 dstAddress, bool tagIncluded) {
+		                                  auto exchangeLock = LockIopExchange();
+		                                  return m_sif.ReceiveDMA6(address, qwc, dstAddress, tagIncluded);
+	                                  });
+	m_sif.SetEeRamWriteHandler(
+	    [this](uint32 address, uint32 size) {
+		    return static_cast<CEeExecutor*>(m_EE.m_executor.get())->PrepareExternalWrite(address, size);
+	    });
 
 	m_ipu.SetDMA3ReceiveHandler(std::bind(&CDMAC::ResumeDMA3, &m_dmac, PLACEHOLDER_1, PLACEHOLDER_2));
 
@@ -157,6 +191,7 @@ CSubSystem::CSubSystem(uint8* iopRam, CIopBios& iopBios)
 	m_OnRequestInstructionCacheFlushConnection = m_os->OnRequestInstructionCacheFlush.Connect(std::bind(&CSubSystem::FlushInstructionCache, this));
 
 	SetupEePageTable();
+	RegisterDeviceEvents();
 }
 
 CSubSystem::~CSubSystem()
@@ -183,6 +218,11 @@ void CSubSystem::SetVpu1(std::shared_ptr<CVpu> newVpu1)
 	m_vpu1 = newVpu1;
 }
 
+void CSubSystem::SetIopExchangeMutex(std::recursive_mutex* iopExchangeMutex)
+{
+	m_iopExchangeMutex = iopExchangeMutex;
+}
+
 void CSubSystem::Reset(uint32 ramSize)
 {
 	m_os->Release();
@@ -226,12 +266,16 @@ void CSubSystem::Reset(uint32 ramSize)
 
 	m_statusRegisterCheckers.clear();
 	m_isIdle = false;
+
+	ResetDeviceEvents();
 }
 
 int CSubSystem::ExecuteCpu(int quota)
 {
 	m_isIdle = false;
 	int executed = 0;
+	//Invalidate blocks overwritten by IOP while it was running on its own thread
+	static_cast<CEeExecutor*>(m_EE.m_executor.get())->ProcessExternalWrites();
 	if(m_EE.m_State.callMsEnabled)
 	{
 		if(!m_vpu0->IsVuRunning())
@@ -250,8 +294,12 @@ int CSubSystem::ExecuteCpu(int quota)
 		switch(m_EE.m_State.nHasException)
 		{
 		case MIPS_EXCEPTION_SYSCALL:
+		{
+			//Syscalls might go through SIF or talk to IOP modules directly
+			auto exchangeLock = LockIopExchange();
 			m_os->HandleSyscall();
-			break;
+		}
+		break;
 		case MIPS_EXCEPTION_TLB:
 			m_os->HandleTLBException();
 			break;
@@ -300,30 +348,12 @@ bool CSubSystem::IsCpuIdle() const
 
 void CSubSystem::CountTicks(int ticks)
 {
-	if(!m_vpu0->IsVuRunning() || (m_vpu0->IsVuRunning() && !m_vpu0->GetVif().IsWaitingForProgramEnd()))
-	{
-		m_dmac.ResumeDMA0();
-	}
-	if(!m_vpu1->IsVuRunning() || (m_vpu1->IsVuRunning() && !m_vpu1->GetVif().IsWaitingForProgramEnd()))
-	{
-		m_dmac.ResumeDMA1();
-	}
-	m_dmac.ResumeDMA2();
-	m_dmac.ResumeDMA8();
-	m_gif.CountTicks(ticks);
-	m_ipu.CountTicks(ticks);
-	m_vpu0->GetVif().CountTicks(ticks);
-	m_vpu1->GetVif().CountTicks(ticks);
-	ExecuteIpu();
-	if(!m_EE.m_State.nHasException)
-	{
-		if((m_EE.m_State.nCOP0[CCOP_SCU::STATUS] & CMIPS::STATUS_EXL) == 0)
-		{
-			m_sif.CountTicks(ticks);
-		}
-	}
+	//Only devices that have reached their deadline are serviced here
+	m_eventScheduler.AdvanceTime(ticks);
+	m_eventScheduler.ProcessDueEvents();
+	RefreshDeviceEvents();
+
 	m_EE.m_State.nCOP0[CCOP_SCU::COUNT] += ticks;
-	m_timer.Count(ticks);
 	if(m_EE.m_State.cop0_pccr & 0x80000000)
 	{
 		auto pccr = make_convertible<CCOP_SCU::PCCR>(m_EE.m_State.cop0_pccr);
@@ -341,9 +371,16 @@ void CSubSystem::CountTicks(int ticks)
 	CheckPendingInterrupts();
 }
 
+uint32 CSubSystem::GetTicksUntilNextEvent()
+{
+	return m_eventScheduler.GetTicksUntilNextEvent();
+}
+
 void CSubSystem::NotifyVBlankStart()
 {
+	m_eventScheduler.SyncEvent(EVENT_TIMER);
 	m_timer.NotifyVBlankStart();
+	m_eventScheduler.SyncEvent(EVENT_TIMER);
 	m_intc.AssertLine(CINTC::INTC_LINE_VBLANK_START);
 	m_os->GetLibMc2().NotifyVBlankStart();
 	if(m_os->CheckVBlankFlag())
@@ -356,12 +393,20 @@ void CSubSystem::NotifyVBlankStart()
 
 void CSubSystem::NotifyVBlankEnd()
 {
+	m_eventScheduler.SyncEvent(EVENT_TIMER);
 	m_timer.NotifyVBlankEnd();
+	m_eventScheduler.SyncEvent(EVENT_TIMER);
 	m_intc.AssertLine(CINTC::INTC_LINE_VBLANK_END);
 }
 
 void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 {
+	//Devices are counted lazily, make sure the ticks elapsed since they were last serviced are saved
+	m_eventScheduler.SyncEvent(EVENT_GIF);
+	m_eventScheduler.SyncEvent(EVENT_VIF0);
+	m_eventScheduler.SyncEvent(EVENT_VIF1);
+	m_eventScheduler.SyncEvent(EVENT_TIMER);
+
 	archive.InsertFile(std::make_unique<CMemoryStateFile>(STATE_EE, &m_EE.m_State, sizeof(MIPSSTATE)));
 	archive.InsertFile(std::make_unique<CMemoryStateFile>(STATE_VU0, &m_VU0.m_State, sizeof(MIPSSTATE)));
 	archive.InsertFile(std::make_unique<CMemoryStateFile>(STATE_VU1, &m_VU1.m_State, sizeof(MIPSSTATE)));
@@ -381,6 +426,8 @@ void CSubSystem::SaveState(Framework::CZipArchiveWriter& archive)
 	m_gif.SaveState(archive);
 	m_ipu.SaveState(archive);
 	m_os->GetLibMc2().SaveState(archive);
+
+	SaveDeviceEvents(archive);
 }
 
 void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
@@ -408,6 +455,9 @@ void CSubSystem::LoadState(Framework::CZipArchiveReader& archive)
 	m_gif.LoadState(archive);
 	m_ipu.LoadState(archive);
 	m_os->GetLibMc2().LoadState(archive);
+
+	ResetDeviceEvents();
+	LoadDeviceEvents(archive);
 }
 
 void CSubSystem::SetupEePageTable()
@@ -424,6 +474,7 @@ uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
 	uint32 nReturn = 0;
 	if(nAddress >= 0x10000000 && nAddress <= 0x1000183F)
 	{
+		m_eventScheduler.SyncEvent(EVENT_TIMER);
 		nReturn = m_timer.GetRegister(nAddress);
 	}
 	else if(nAddress >= 0x10002000 && nAddress <= 0x1000203F)
@@ -432,6 +483,7 @@ uint32 CSubSystem::IOPortReadHandler(uint32 nAddress)
 	}
 	else if(nAddress >= CGIF::REGS_START && nAddress < CGIF::REGS_END)
 	{
+		m_eventScheduler.SyncEvent(EVENT_GIF);
 		nReturn = m_gif.GetRegister(nAddress);
 	}
 	else if(nAddress >= CVif::REGS0_START && nAddress < CVif::REGS0_END)
@@ -499,7 +551,9 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 {
 	if(nAddress >= 0x10000000 && nAddress <= 0x1000183F)
 	{
+		m_eventScheduler.SyncEvent(EVENT_TIMER);
 		m_timer.SetRegister(nAddress, nData);
+		m_eventScheduler.SyncEvent(EVENT_TIMER);
 	}
 	else if(nAddress >= 0x10002000 && nAddress <= 0x1000203F)
 	{
@@ -547,6 +601,7 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 	else if(nAddress == 0x1000F180)
 	{
 		//stdout data
+		auto exchangeLock = LockIopExchange();
 		m_iopBios.GetIoman()->Write(Iop::CIoman::FID_STDOUT, 1, &nData);
 	}
 	else if(nAddress >= 0x1000F520 && nAddress <= 0x1000F59C)
@@ -579,6 +634,9 @@ uint32 CSubSystem::IOPortWriteHandler(uint32 nAddress, uint32 nData)
 		                         nAddress, nData, m_EE.m_State.nPC);
 	}
 
+	//Write might have started a transfer or a delayed operation on a device
+	RefreshDeviceEvents();
+
 	bool isInterruptPending = m_intc.IsInterruptPending() || m_dmac.IsInterruptPending();
 	if(
 	    isInterruptPending &&
@@ -786,6 +844,164 @@ void CSubSystem::CheckPendingInterrupts()
 	}
 }
 
+void CSubSystem::RegisterDeviceEvents()
+{
+	m_eventScheduler.RegisterEvent(EVENT_DMA, [this](uint32 ticks) { ServiceDma(ticks); });
+	m_eventScheduler.RegisterEvent(EVENT_GIF, [this](uint32 ticks) { m_gif.CountTicks(ticks); });
+	m_eventScheduler.RegisterEvent(EVENT_IPU, [this](uint32 ticks) { ServiceIpu(ticks); });
+	m_eventScheduler.RegisterEvent(EVENT_VIF0, [this](uint32 ticks) { m_vpu0->GetVif().CountTicks(ticks); });
+	m_eventScheduler.RegisterEvent(EVENT_VIF1, [this](uint32 ticks) { m_vpu1->GetVif().CountTicks(ticks); });
+	m_eventScheduler.RegisterEvent(EVENT_SIF, [this](uint32 ticks) { ServiceSif(ticks); });
+	m_eventScheduler.RegisterEvent(EVENT_TIMER, [this](uint32 ticks) { ServiceTimer(ticks); });
+}
+
+void CSubSystem::ResetDeviceEvents()
+{
+	m_sifDeferredTicks = 0;
+	m_eventScheduler.Reset();
+	RefreshDeviceEvents();
+	m_eventScheduler.SyncEvent(EVENT_TIMER);
+}
+
+void CSubSystem::SaveDeviceEvents(Framework::CZipArchiveWriter& archive)
+{
+	static_assert(std::size(g_eventStateNames) == EVENT_COUNT, "Event state name missing.");
+	auto registerFile = std::make_unique<CRegisterStateFile>(STATE_EVENTS_XML);
+	for(unsigned int i = 0; i < EVENT_COUNT; i++)
+	{
+		registerFile->SetRegister32(g_eventStateNames[i], m_eventScheduler.GetTicksUntilEvent(i));
+	}
+	registerFile->SetRegister32(STATE_EVENTS_SIF_DEFERRED_TICKS, m_sifDeferredTicks);
+	archive.InsertFile(std::move(registerFile));
+}
+
+void CSubSystem::LoadDeviceEvents(Framework::CZipArchiveReader& archive)
+{
+	//Older states don't have this, deadlines will be computed from device state
+	if(!archive.GetFileHeader(STATE_EVENTS_XML)) return;
+
+	auto registerFile = CRegisterStateFile(*archive.BeginReadFile(STATE_EVENTS_XML));
+	for(unsigned int i = 0; i < EVENT_COUNT; i++)
+	{
+		//Events not present in the state keep the deadline computed from device state by ResetDeviceEvents
+		if(!registerFile.HasRegister(g_eventStateNames[i])) continue;
+		uint32 delay = registerFile.GetRegister32(g_eventStateNames[i]);
+		m_eventScheduler.CancelEvent(i);
+		if(delay != CEventScheduler::NO_EVENT_PENDING)
+		{
+			m_eventScheduler.ScheduleEvent(i, delay);
+		}
+	}
+	m_sifDeferredTicks = registerFile.GetRegister32(STATE_EVENTS_SIF_DEFERRED_TICKS);
+}
+
+void CSubSystem::RefreshDeviceEvents()
+{
+	//Make sure devices with pending work get a deadline. Devices that need to be polled
+	//(stalled transfers, pending commands) are serviced on the next time slice.
+	if(m_dmac.IsResumableDMAStarted())
+	{
+		ScheduleDeviceEvent(EVENT_DMA, 0);
+	}
+	if(m_gif.GetPath3XferActiveTicks() > 0)
+	{
+		ScheduleDeviceEvent(EVENT_GIF, m_gif.GetPath3XferActiveTicks());
+	}
+	if(m_ipu.WillExecuteCommand() || m_dmac.IsDMA4Started())
+	{
+		ScheduleDeviceEvent(EVENT_IPU, 0);
+	}
+	if(m_vpu0->GetVif().GetInterruptDelayTicks() > 0)
+	{
+		ScheduleDeviceEvent(EVENT_VIF0, m_vpu0->GetVif().GetInterruptDelayTicks());
+	}
+	if(m_vpu1->GetVif().GetInterruptDelayTicks() > 0)
+	{
+		ScheduleDeviceEvent(EVENT_VIF1, m_vpu1->GetVif().GetInterruptDelayTicks());
+	}
+	{
+		//If IOP is busy, assume SIF has something to do, ServiceSif will try again later
+		auto exchangeLock = TryLockIopExchange();
+		bool iopBusy = m_iopExchangeMutex && !exchangeLock.owns_lock();
+		if(iopBusy || m_sif.HasPendingWork())
+		{
+			ScheduleDeviceEvent(EVENT_SIF, 0);
+		}
+	}
+}
+
+void CSubSystem::ScheduleDeviceEvent(EVENT eventId, uint32 delay)
+{
+	//Keep existing deadline, the device will be rescheduled after being serviced
+	if(m_eventScheduler.IsEventScheduled(eventId)) return;
+	m_eventScheduler.ScheduleEvent(eventId, delay);
+}
+
+void CSubSystem::ServiceDma(uint32)
+{
+	if(!m_vpu0->IsVuRunning() || (m_vpu0->IsVuRunning() && !m_vpu0->GetVif().IsWaitingForProgramEnd()))
+	{
+		m_dmac.ResumeDMA0();
+	}
+	if(!m_vpu1->IsVuRunning() || (m_vpu1->IsVuRunning() && !m_vpu1->GetVif().IsWaitingForProgramEnd()))
+	{
+		m_dmac.ResumeDMA1();
+	}
+	m_dmac.ResumeDMA2();
+	m_dmac.ResumeDMA8();
+}
+
+void CSubSystem::ServiceIpu(uint32 ticks)
+{
+	m_ipu.CountTicks(ticks);
+	ExecuteIpu();
+}
+
+void CSubSystem::ServiceSif(uint32 ticks)
+{
+	if(!m_EE.m_State.nHasException)
+	{
+		if((m_EE.m_State.nCOP0[CCOP_SCU::STATUS] & CMIPS::STATUS_EXL) == 0)
+		{
+			//Don't wait for IOP here, keep the elapsed ticks for the next attempt
+			auto exchangeLock = TryLockIopExchange();
+			if(m_iopExchangeMutex && !exchangeLock.owns_lock())
+			{
+				m_sifDeferredTicks += ticks;
+				return;
+			}
+			m_sif.CountTicks(m_sifDeferredTicks + ticks);
+			m_sifDeferredTicks = 0;
+		}
+	}
+}
+
+void CSubSystem::ServiceTimer(uint32 ticks)
+{
+	m_timer.Count(ticks);
+	uint32 nextTimerEvent = m_timer.GetTicksUntilNextEvent();
+	if(nextTimerEvent != ~0U)
+	{
+		m_eventScheduler.ScheduleEvent(EVENT_TIMER, nextTimerEvent);
+	}
+	else
+	{
+		m_eventScheduler.CancelEvent(EVENT_TIMER);
+	}
+}
+
+CSubSystem::IopExchangeLock CSubSystem::LockIopExchange()
+{
+	if(!m_iopExchangeMutex) return IopExchangeLock();
+	return IopExchangeLock(*m_iopExchangeMutex);
+}
+
+CSubSystem::IopExchangeLock CSubSystem::TryLockIopExchange()
+{
+	if(!m_iopExchangeMutex) return IopExchangeLock();
+	return IopExchangeLock(*m_iopExchangeMutex, std::try_to_lock);
+}
+
 void CSubSystem::FlushInstructionCache()
 {
 	m_EE.m_executor->Reset();
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include "AlignedAlloc.h"
 #include "../COP_SCU.h"
 #include "../COP_FPU.h"
@@ -16,6 +17,7 @@
 #include "COP_VU.h"
 #include "PS2OS.h"
 #include "../gs/GSHandler.h"
+#include "../EventScheduler.h"
 
 #include "signal/Signal.h"
 
@@ -31,6 +33,7 @@ namespace Ee
 		int ExecuteCpu(int);
 		bool IsCpuIdle() const;
 		void CountTicks(int);
+		uint32 GetTicksUntilNextEvent();
 
 		void NotifyVBlankStart();
 		void NotifyVBlankEnd();
@@ -41,6 +44,8 @@ namespace Ee
 		void SetVpu0(std::shared_ptr<CVpu>);
 		void SetVpu1(std::shared_ptr<CVpu>);
 
+		void SetIopExchangeMutex(std::recursive_mutex*);
+
 		uint8* m_ram = nullptr;
 		uint8* m_bios = nullptr;
 		uint8* m_spr = nullptr;
@@ -80,6 +85,19 @@ namespace Ee
 
 	private:
 		typedef std::map<uint32, uint32> StatusRegisterCheckerMap;
+		typedef std::unique_lock<std::recursive_mutex> IopExchangeLock;
+
+		enum EVENT
+		{
+			EVENT_DMA,
+			EVENT_GIF,
+			EVENT_IPU,
+			EVENT_VIF0,
+			EVENT_VIF1,
+			EVENT_SIF,
+			EVENT_TIMER,
+			EVENT_COUNT,
+		};
 
 		void SetupEePageTable();
 
@@ -104,6 +122,20 @@ namespace Ee
 
 		void CheckPendingInterrupts();
 
+		void RegisterDeviceEvents();
+		void RefreshDeviceEvents();
+		void ScheduleDeviceEvent(EVENT, uint32);
+		void ResetDeviceEvents();
+		void SaveDeviceEvents(Framework::CZipArchiveWriter&);
+		void LoadDeviceEvents(Framework::CZipArchiveReader&);
+		void ServiceDma(uint32);
+		void ServiceIpu(uint32);
+		void ServiceSif(uint32);
+		void ServiceTimer(uint32);
+
+		IopExchangeLock LockIopExchange();
+		IopExchangeLock TryLockIopExchange();
+
 		void FlushInstructionCache();
 
 		void LoadBIOS();
@@ -119,6 +151,12 @@ namespace Ee
 		CCOP_FPU m_COP_FPU;
 		CCOP_VU m_COP_VU;
 
+		CEventScheduler m_eventScheduler;
+
+		//Held while touching state shared with an IOP running on another thread
+		std::recursive_mutex* m_iopExchangeMutex = nullptr;
+		uint32 m_sifDeferredTicks = 0;
+
 		Framework::CSignal<void()>::Connection m_OnRequestInstructionCacheFlushConnection;
 		CVpu::VuStateChangedEvent::Connection m_vu0StateChangedConnection;
 	};
@@ -1,6 +1,7 @@
 #include <stdio.h>
 #include <algorithm>
 #include <cstring>
+#include "SimdDefs.h"
 #include "../uint128.h"
 #include "../Ps2Const.h"
 #include "../Log.h"
@@ -30,6 +31,109 @@
 
 #define STATE_FIFO_BUFFER ("gif/fifo")
 
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+#include <emmintrin.h>
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+#include <arm_neon.h>
+#endif
+
+//Register lists that are decoded with a specialized loop (common vertex strips)
+// clang-format off
+const CGIF::PACKED_RUN_SIGNATURE CGIF::m_packedRunSignatures[] =
+{
+	{1, 0x005, &CGIF::ProcessPackedRun<0x05>},
+	{2, 0x051, &CGIF::ProcessPackedRun<0x01, 0x05>},
+	{2, 0x041, &CGIF::ProcessPackedRun<0x01, 0x04>},
+	{2, 0x052, &CGIF::ProcessPackedRun<0x02, 0x05>},
+	{2, 0x053, &CGIF::ProcessPackedRun<0x03, 0x05>},
+	{3, 0x512, &CGIF::ProcessPackedRun<0x02, 0x01, 0x05>},
+	{3, 0x412, &CGIF::ProcessPackedRun<0x02, 0x01, 0x04>},
+	{3, 0x521, &CGIF::ProcessPackedRun<0x01, 0x02, 0x05>},
+	{3, 0x421, &CGIF::ProcessPackedRun<0x01, 0x02, 0x04>},
+	{3, 0x513, &CGIF::ProcessPackedRun<0x03, 0x01, 0x05>},
+	{3, 0x413, &CGIF::ProcessPackedRun<0x03, 0x01, 0x04>},
+	{3, 0x531, &CGIF::ProcessPackedRun<0x01, 0x03, 0x05>},
+};
+// clang-format on
+
+//Packs the low byte of each component (RGBA)
+static uint32 PackPackedColor(const uint8* packet)
+{
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+	__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packet));
+	value = _mm_and_si128(value, _mm_set1_epi32(0xFF));
+	value = _mm_packs_epi32(value, value);
+	value = _mm_packus_epi16(value, value);
+	return _mm_cvtsi128_si32(value);
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+	uint32x4_t value = vld1q_u32(reinterpret_cast<const uint32*>(packet));
+	uint16x4_t value16 = vmovn_u32(value);
+	uint8x8_t value8 = vmovn_u16(vcombine_u16(value16, value16));
+	return vget_lane_u32(vreinterpret_u32_u8(value8), 0);
+#else
+	auto components = reinterpret_cast<const uint32*>(packet);
+	return (components[0] & 0xFF) | ((components[1] & 0xFF) << 8) | ((components[2] & 0xFF) << 16) | ((components[3] & 0xFF) << 24);
+#endif
+}
+
+//Packs the low 16 bits of the first two components (XY or UV)
+static uint32 PackPackedCoords(const uint8* packet)
+{
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+	__m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(packet));
+	value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(3, 3, 2, 0));
+	return _mm_cvtsi128_si32(value);
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+	uint16x4_t value16 = vmovn_u32(vld1q_u32(reinterpret_cast<const uint32*>(packet)));
+	return vget_lane_u32(vreinterpret_u32_u16(value16), 0);
+#else
+	auto components = reinterpret_cast<const uint32*>(packet);
+	return (components[0] & 0xFFFF) | ((components[1] & 0xFFFF) << 16);
+#endif
+}
+
+template <uint32 RegDesc>
+static inline void DecodePackedRegister(const uint8*& packet, CGSHandler::RegisterWrite*& writes, uint32& qtemp)
+{
+	static_assert((RegDesc >= 0x01) && (RegDesc <= 0x05), "Unsupported register descriptor.");
+	auto components = reinterpret_cast<const uint32*>(packet);
+	if constexpr(RegDesc == 0x01)
+	{
+		//RGBA
+		uint64 value = PackPackedColor(packet) | (static_cast<uint64>(qtemp) << 32);
+		*writes++ = CGSHandler::RegisterWrite(GS_REG_RGBAQ, value);
+	}
+	else if constexpr(RegDesc == 0x02)
+	{
+		//ST
+		qtemp = components[2];
+		*writes++ = CGSHandler::RegisterWrite(GS_REG_ST, *reinterpret_cast<const uint64*>(packet));
+	}
+	else if constexpr(RegDesc == 0x03)
+	{
+		//UV
+		uint64 value = PackPackedCoords(packet) & 0x7FFF7FFF;
+		*writes++ = CGSHandler::RegisterWrite(GS_REG_UV, value);
+	}
+	else if constexpr(RegDesc == 0x04)
+	{
+		//XYZF2
+		uint64 value = PackPackedCoords(packet);
+		value |= static_cast<uint64>(components[2] & 0x0FFFFFF0) << 28;
+		value |= static_cast<uint64>(components[3] & 0x00000FF0) << 52;
+		uint8 reg = (components[3] & 0x8000) ? GS_REG_XYZF3 : GS_REG_XYZF2;
+		*writes++ = CGSHandler::RegisterWrite(reg, value);
+	}
+	else if constexpr(RegDesc == 0x05)
+	{
+		//XYZ2
+		uint64 value = PackPackedCoords(packet) | (static_cast<uint64>(components[2]) << 32);
+		uint8 reg = (components[3] & 0x8000) ? GS_REG_XYZ3 : GS_REG_XYZ2;
+		*writes++ = CGSHandler::RegisterWrite(reg, value);
+	}
+	packet += 0x10;
+}
+
 CGIF::CGIF(CGSHandler*& gs, CDMAC& dmac, uint8* ram, uint8* spr)
     : m_qtemp(QTEMP_INIT)
     , m_ram(ram)
@@ -52,6 +156,7 @@ void CGIF::Reset()
 	m_regList = 0;
 	m_eop = false;
 	m_qtemp = QTEMP_INIT;
+	m_packedRunProcessor = nullptr;
 	m_signalState = SIGNAL_STATE_NONE;
 	m_maskedPath3XferState = MASKED_PATH3_XFER_NONE;
 	m_path3XferActiveTicks = 0;
@@ -75,6 +180,7 @@ void CGIF::LoadState(Framework::CZipArchiveReader& archive)
 		m_qtemp = registerFile.GetRegister32(STATE_REGS_QTEMP);
 		m_path3XferActiveTicks = registerFile.GetRegister32(STATE_REGS_PATH3_XFER_ACTIVE_TICKS);
 		m_fifoIndex = registerFile.GetRegister32(STATE_REGS_FIFO_INDEX);
+		m_packedRunProcessor = FindPackedRunProcessor();
 	}
 
 	archive.BeginReadFile(STATE_FIFO_BUFFER)->Read(m_fifoBuffer, FIFO_SIZE);
@@ -108,6 +214,16 @@ uint32 CGIF::ProcessPacked(const uint8* memory, uint32 address, uint32 end)
 
 	while((m_loops != 0) && (address < end))
 	{
+		if(m_packedRunProcessor && (m_regsTemp == m_regs))
+		{
+			uint32 runSize = (this->*m_packedRunProcessor)(memory, address, end);
+			if(runSize != 0)
+			{
+				address += runSize;
+				continue;
+			}
+		}
+
 		while((m_regsTemp != 0) && (address < end))
 		{
 			uint64 temp = 0;
@@ -235,6 +351,47 @@ uint32 CGIF::ProcessPacked(const uint8* memory, uint32 address, uint32 end)
 	return address - start;
 }
 
+template <uint32... RegDescs>
+uint32 CGIF::ProcessPackedRun(const uint8* memory, uint32 address, uint32 end)
+{
+	//Converts all complete loops available at once, partial loops go through the generic path
+	static const uint32 regCount = sizeof...(RegDescs);
+	assert(m_regs == regCount);
+	assert(m_regsTemp == m_regs);
+
+	uint32 loopCount = std::min<uint32>(m_loops, (end - address) / (regCount * 0x10));
+	if(loopCount == 0) return 0;
+
+	auto writes = m_gs->ReserveRegisterWrites(loopCount * regCount);
+	if(writes == nullptr) return 0;
+
+	auto packet = memory + address;
+	uint32 qtemp = m_qtemp;
+	for(uint32 i = 0; i < loopCount; i++)
+	{
+		(DecodePackedRegister<RegDescs>(packet, writes, qtemp), ...);
+	}
+	m_qtemp = qtemp;
+	m_loops -= loopCount;
+
+	return loopCount * regCount * 0x10;
+}
+
+CGIF::PackedRunProcessor CGIF::FindPackedRunProcessor() const
+{
+	if(m_cmd != 0) return nullptr;
+	for(const auto& signature : m_packedRunSignatures)
+	{
+		if(signature.regs != m_regs) continue;
+		uint64 regListMask = (1ULL << (m_regs * 4)) - 1;
+		if((m_regList & regListMask) == signature.regList)
+		{
+			return signature.processor;
+		}
+	}
+	return nullptr;
+}
+
 uint32 CGIF::ProcessRegList(const uint8* memory, uint32 address, uint32 end)
 {
 	uint32 start = address;
@@ -344,6 +501,7 @@ uint32 CGIF::ProcessSinglePacket(const uint8* memory, uint32 memorySize, uint32
 
 			if(m_regs == 0) m_regs = 0x10;
 			m_regsTemp = m_regs;
+			m_packedRunProcessor = FindPackedRunProcessor();
 			m_activePath = packetMetadata.pathIndex;
 			continue;
 		}
@@ -539,6 +697,11 @@ void CGIF::CountTicks(uint32 cycles)
 	m_path3XferActiveTicks = std::max<int32>(m_path3XferActiveTicks - cycles, 0);
 }
 
+int32 CGIF::GetPath3XferActiveTicks() const
+{
+	return m_path3XferActiveTicks;
+}
+
 uint32 CGIF::GetRegister(uint32 address)
 {
 	uint32 result = 0;
@@ -57,6 +57,7 @@ public:
 	uint32 ProcessMultiplePackets(const uint8*, uint32, uint32, uint32, const CGsPacketMetadata&);
 
 	void CountTicks(uint32);
+	int32 GetPath3XferActiveTicks() const;
 
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
@@ -90,7 +91,19 @@ private:
 		MASKED_PATH3_XFER_DONE,
 	};
 
+	typedef uint32 (CGIF::*PackedRunProcessor)(const uint8*, uint32, uint32);
+
+	struct PACKED_RUN_SIGNATURE
+	{
+		uint8 regs;
+		uint64 regList;
+		PackedRunProcessor processor;
+	};
+
 	uint32 ProcessPacked(const uint8*, uint32, uint32);
+	template <uint32... RegDescs>
+	uint32 ProcessPackedRun(const uint8*, uint32, uint32);
+	PackedRunProcessor FindPackedRunProcessor() const;
 	uint32 ProcessRegList(const uint8*, uint32, uint32);
 	uint32 ProcessImage(const uint8*, uint32, uint32, uint32);
 
@@ -111,6 +124,7 @@ private:
 	uint64 m_regList = 0;
 	bool m_eop = false;
 	uint32 m_qtemp;
+	PackedRunProcessor m_packedRunProcessor = nullptr;
 	SIGNAL_STATE m_signalState = SIGNAL_STATE_NONE;
 	MASKED_PATH3_XFER_STATE m_maskedPath3XferState = MASKED_PATH3_XFER_NONE;
 	int32 m_path3XferActiveTicks = 0;
@@ -122,4 +136,6 @@ private:
 	CDMAC& m_dmac;
 
 	CProfiler::ZoneHandle m_gifProfilerZone = 0;
+
+	static const PACKED_RUN_SIGNATURE m_packedRunSignatures[];
 };
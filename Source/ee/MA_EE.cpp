@@ -107,6 +107,17 @@ void CMA_EE::LQ()
 {
 	if(m_nRT == 0) return;
 
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(0x10);
+
+		m_codeGen->MD_LoadFromRefIdx(1);
+		m_codeGen->MD_PullRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		m_codeGen->Else();
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -148,11 +159,27 @@ void CMA_EE::LQ()
 		}
 	}
 	m_codeGen->EndIf();
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 //1F
 void CMA_EE::SQ()
 {
+	bool useFastMem = BeginFastMemAccess();
+
+	if(useFastMem)
+	{
+		ComputeMemAccessFastRefIdx(0x10);
+
+		m_codeGen->MD_PushRel(offsetof(CMIPS, m_State.nGPR[m_nRT]));
+		m_codeGen->MD_StoreAtRefIdx(1);
+		m_codeGen->Else();
+	}
+
 	ComputeMemAccessPageRef();
 
 	m_codeGen->PushCst(0);
@@ -194,6 +221,11 @@ void CMA_EE::SQ()
 		}
 	}
 	m_codeGen->EndIf();
+
+	if(useFastMem)
+	{
+		m_codeGen->EndIf();
+	}
 }
 
 //////////////////////////////////////////////////
@@ -275,6 +275,11 @@ void CSIF::CountTicks(uint32 ticks)
 	}
 }
 
+bool CSIF::HasPendingWork() const
+{
+	return !m_bindReplies.empty() || !m_packetQueue.empty();
+}
+
 void CSIF::MarkPacketProcessed()
 {
 	assert(m_packetProcessed == false);
@@ -669,6 +674,7 @@ void CSIF::SendCallReply(uint32 serverId, const void* returnData)
 		//Size needs to be a multiple of 4
 		assert((requestInfo.call.recvSize & 0x03) == 0);
 		uint32 dstSize = (requestInfo.call.recvSize + 0x03) & ~0x03;
+		auto writeLock = PrepareEeRamWrite(dstPtr, dstSize);
 		memcpy(m_eeRam + dstPtr, returnData, dstSize);
 	}
 	SendPacket(&requestInfo.reply, sizeof(SIFRPCREQUESTEND));
@@ -685,6 +691,17 @@ void CSIF::SetCustomCommandHandler(const CustomCommandHandler& customCommandHand
 	m_customCommandHandler = customCommandHandler;
 }
 
+void CSIF::SetEeRamWriteHandler(const EeRamWriteHandler& eeRamWriteHandler)
+{
+	m_eeRamWriteHandler = eeRamWriteHandler;
+}
+
+CSIF::EeRamWriteLock CSIF::PrepareEeRamWrite(uint32 address, uint32 size)
+{
+	if(!m_eeRamWriteHandler) return EeRamWriteLock();
+	return m_eeRamWriteHandler(address, size);
+}
+
 /////////////////////////////////////////////////////////
 //Get/Set Register
 /////////////////////////////////////////////////////////
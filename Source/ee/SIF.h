@@ -1,6 +1,7 @@
 #pragma once
 
 #include <map>
+#include <mutex>
 #include <vector>
 #include "../SifDefs.h"
 #include "../SifModule.h"
@@ -14,6 +15,8 @@ class CSIF
 public:
 	typedef std::function<void(const std::string&)> ModuleResetHandler;
 	typedef std::function<void(uint32)> CustomCommandHandler;
+	typedef std::unique_lock<std::mutex> EeRamWriteLock;
+	typedef std::function<EeRamWriteLock(uint32, uint32)> EeRamWriteHandler;
 
 	CSIF(CDMAC&, uint8*, uint8*);
 	virtual ~CSIF() = default;
@@ -21,6 +24,7 @@ public:
 	void Reset();
 
 	void CountTicks(uint32);
+	bool HasPendingWork() const;
 	void MarkPacketProcessed();
 
 	void RegisterModule(uint32, CSifModule*);
@@ -31,6 +35,10 @@ public:
 	void SendCallReply(uint32, const void*);
 	void SetModuleResetHandler(const ModuleResetHandler&);
 	void SetCustomCommandHandler(const CustomCommandHandler&);
+	void SetEeRamWriteHandler(const EeRamWriteHandler&);
+
+	//Must be held while writing to EE RAM from IOP modules
+	EeRamWriteLock PrepareEeRamWrite(uint32, uint32);
 
 	uint32 ReceiveDMA5(uint32, uint32, uint32, bool);
 	uint32 ReceiveDMA6(uint32, uint32, uint32, bool);
@@ -115,4 +123,5 @@ private:
 
 	ModuleResetHandler m_moduleResetHandler;
 	CustomCommandHandler m_customCommandHandler;
+	EeRamWriteHandler m_eeRamWriteHandler;
 };
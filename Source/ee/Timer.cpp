@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <stdio.h>
 #include "../Log.h"
@@ -33,27 +34,7 @@ void CTimer::Count(unsigned int ticks)
 		uint32 previousCount = timer.nCOUNT;
 		uint32 nextCount = timer.nCOUNT;
 
-		uint32 divider = 1;
-		//BUSCLOCK runs at half EE frequency
-		switch(timer.nMODE & MODE_CLOCK_SELECT)
-		{
-		case MODE_CLOCK_SELECT_BUSCLOCK:
-			divider = 1 * 2;
-			break;
-		case MODE_CLOCK_SELECT_BUSCLOCK16:
-			divider = 16 * 2;
-			break;
-		case MODE_CLOCK_SELECT_BUSCLOCK256:
-			divider = 256 * 2;
-			break;
-		case MODE_CLOCK_SELECT_EXTERNAL:
-		{
-			assert(m_gs);
-			uint32 hSyncFreq = m_gs->GetCrtHSyncFrequency();
-			divider = PS2::EE_CLOCK_FREQ / hSyncFreq;
-		}
-		break;
-		}
+		uint32 divider = GetClockDivider(timer);
 
 		//Compute increment
 		uint32 totalTicks = timer.clockRemain + ticks;
@@ -98,6 +79,53 @@ void CTimer::Count(unsigned int ticks)
 	}
 }
 
+uint32 CTimer::GetTicksUntilNextEvent() const
+{
+	//Computes the amount of ticks until a timer reaches its compare value or overflows.
+	//Counting more than this in one go would skip flag updates and interrupts.
+	uint32 result = ~0U;
+	for(unsigned int i = 0; i < MAX_TIMER; i++)
+	{
+		const auto& timer = m_timer[i];
+
+		if(!(timer.nMODE & MODE_COUNT_ENABLE)) continue;
+
+		uint32 divider = GetClockDivider(timer);
+		uint32 compare = (timer.nCOMP == 0) ? 0x10000 : timer.nCOMP;
+		uint32 target = (timer.nCOUNT < compare) ? compare : 0x10000;
+		uint64 ticks = static_cast<uint64>(target - timer.nCOUNT) * divider;
+		ticks -= std::min<uint64>(ticks, timer.clockRemain);
+		result = static_cast<uint32>(std::min<uint64>(result, ticks));
+	}
+	return result;
+}
+
+uint32 CTimer::GetClockDivider(const TIMER& timer) const
+{
+	uint32 divider = 1;
+	//BUSCLOCK runs at half EE frequency
+	switch(timer.nMODE & MODE_CLOCK_SELECT)
+	{
+	case MODE_CLOCK_SELECT_BUSCLOCK:
+		divider = 1 * 2;
+		break;
+	case MODE_CLOCK_SELECT_BUSCLOCK16:
+		divider = 16 * 2;
+		break;
+	case MODE_CLOCK_SELECT_BUSCLOCK256:
+		divider = 256 * 2;
+		break;
+	case MODE_CLOCK_SELECT_EXTERNAL:
+	{
+		assert(m_gs);
+		uint32 hSyncFreq = m_gs->GetCrtHSyncFrequency();
+		divider = PS2::EE_CLOCK_FREQ / hSyncFreq;
+	}
+	break;
+	}
+	return divider;
+}
+
 uint32 CTimer::GetRegister(uint32 nAddress)
 {
 	DisassembleGet(nAddress);
@@ -56,6 +56,7 @@ public:
 	void Reset();
 
 	void Count(unsigned int);
+	uint32 GetTicksUntilNextEvent() const;
 
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
@@ -87,6 +88,8 @@ private:
 		uint32 clockRemain;
 	};
 
+	uint32 GetClockDivider(const TIMER&) const;
+
 	TIMER m_timer[MAX_TIMER];
 	CINTC& m_intc;
 	CGSHandler*& m_gs;
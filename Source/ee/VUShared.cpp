@@ -198,6 +198,12 @@ void VUShared::PullIntegerRegister(CMipsJitter* codeGen, unsigned int regIdx)
 
 void VUShared::TestSZFlags(CMipsJitter* codeGen, uint8 dest, size_t regOffset, uint32 relativePipeTime, uint32 compileHints)
 {
+	//Nothing will ever look at these flags, don't compute them
+	if((compileHints & COMPILEHINT_SKIPFMACUPDATE) && (compileHints & COMPILEHINT_SKIPSTICKYUPDATE))
+	{
+		return;
+	}
+
 	codeGen->MD_PushRel(regOffset);
 	codeGen->MD_MakeSignZero();
 
@@ -93,6 +93,7 @@ namespace VUShared
 	enum COMPILEHINT
 	{
 		COMPILEHINT_SKIPFMACUPDATE = 0x01,
+		COMPILEHINT_SKIPSTICKYUPDATE = 0x02,
 	};
 
 	uint32 MakeDestFromComponent(uint32);
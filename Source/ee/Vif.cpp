@@ -264,6 +264,11 @@ void CVif::CountTicks(uint32 ticks)
 	}
 }
 
+int32 CVif::GetInterruptDelayTicks() const
+{
+	return m_interruptDelayTicks;
+}
+
 void CVif::SaveState(Framework::CZipArchiveWriter& archive)
 {
 	{
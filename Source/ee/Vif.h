@@ -62,6 +62,7 @@ public:
 	uint32 GetRegister(uint32);
 	void SetRegister(uint32, uint32);
 	void CountTicks(uint32);
+	int32 GetInterruptDelayTicks() const;
 	virtual void SaveState(Framework::CZipArchiveWriter&);
 	virtual void LoadState(Framework::CZipArchiveReader&);
 
@@ -4,8 +4,10 @@
 #include "MemoryUtils.h"
 #include "Vpu.h"
 
-CVuBasicBlock::CVuBasicBlock(CMIPS& context, uint32 begin, uint32 end, BLOCK_CATEGORY category)
+CVuBasicBlock::CVuBasicBlock(CMIPS& context, uint32 begin, uint32 end, BLOCK_CATEGORY category, bool trailingFlagsUsed, bool statusFlagUsed)
     : CBasicBlock(context, begin, end, category)
+    , m_trailingFlagsUsed(trailingFlagsUsed)
+    , m_statusFlagUsed(statusFlagUsed)
 {
 }
 
@@ -602,12 +604,15 @@ void CVuBasicBlock::ComputeSkipFlagsHints(const std::vector<uint32>& fmacStallDe
 	}
 
 	//Simulate usage from outside our block
-	for(uint32 relativePipeTime = maxPipeTime; relativePipeTime < extendedMaxPipeTime; relativePipeTime++)
+	if(m_trailingFlagsUsed)
 	{
-		uint32 pipeTimeForResult = flagsResults[relativePipeTime];
-		if(pipeTimeForResult != g_undefinedMACflagsResult)
+		for(uint32 relativePipeTime = maxPipeTime; relativePipeTime < extendedMaxPipeTime; relativePipeTime++)
 		{
-			resultUsed[pipeTimeForResult] = true;
+			uint32 pipeTimeForResult = flagsResults[relativePipeTime];
+			if(pipeTimeForResult != g_undefinedMACflagsResult)
+			{
+				resultUsed[pipeTimeForResult] = true;
+			}
 		}
 	}
 
@@ -619,6 +624,11 @@ void CVuBasicBlock::ComputeSkipFlagsHints(const std::vector<uint32>& fmacStallDe
 		{
 			hints[instructionIndex] |= VUShared::COMPILEHINT_SKIPFMACUPDATE;
 		}
+		if(!m_statusFlagUsed)
+		{
+			//Status flag is never read, sticky flags don't need to be accumulated
+			hints[instructionIndex] |= VUShared::COMPILEHINT_SKIPSTICKYUPDATE;
+		}
 	}
 }
 
@@ -5,7 +5,7 @@
 class CVuBasicBlock : public CBasicBlock
 {
 public:
-	CVuBasicBlock(CMIPS&, uint32, uint32, BLOCK_CATEGORY);
+	CVuBasicBlock(CMIPS&, uint32, uint32, BLOCK_CATEGORY, bool, bool);
 	virtual ~CVuBasicBlock() = default;
 
 	bool IsLinkable() const;
@@ -45,4 +45,9 @@ private:
 	static void EmitXgKick(CMipsJitter*);
 
 	bool m_isLinkable = true;
+
+	//Whether MAC flags computed at the end of this block can be read by what follows
+	bool m_trailingFlagsUsed = true;
+	//Whether status flag can be read by anything
+	bool m_statusFlagUsed = true;
 };
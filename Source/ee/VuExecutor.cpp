@@ -1,19 +1,31 @@
+#include <algorithm>
 #include "VuExecutor.h"
 #include "VuBasicBlock.h"
 #include "VUShared.h"
+#include "MA_VU.h"
 #include "xxhash.h"
 
-CVuExecutor::CVuExecutor(CMIPS& context, uint32 maxAddress)
+CVuExecutor::CVuExecutor(CMIPS& context, uint32 maxAddress, bool flagsObservedExternally)
     : CGenericMipsExecutor(context, maxAddress, BLOCK_CATEGORY_PS2_VU)
+    , m_flagsObservedExternally(flagsObservedExternally)
 {
 }
 
 void CVuExecutor::Reset()
 {
 	m_cachedBlocks.clear();
+	m_flagsDependencies.clear();
+	m_programFlagsUsageDirty = true;
 	CGenericMipsExecutor::Reset();
 }
 
+void CVuExecutor::ClearActiveBlocksInRange(uint32 start, uint32 end, bool executing)
+{
+	CGenericMipsExecutor::ClearActiveBlocksInRange(start, end, executing);
+	ClearFlagsDependentBlocks(start, end, executing);
+	m_programFlagsUsageDirty = true;
+}
+
 BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end)
 {
 	uint32 blockSize = ((end - begin) + 4) / 4;
@@ -28,7 +40,9 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 	uint128 hash;
 	memcpy(&hash, &xxHash, sizeof(xxHash));
 	static_assert(sizeof(hash) == sizeof(xxHash));
-	auto blockKey = std::make_pair(hash, blockSizeByte);
+	bool statusFlagUsed = m_flagsObservedExternally || m_programReadsFlags;
+	bool trailingFlagsUsed = m_flagsObservedExternally || (m_programReadsFlags && AreTrailingFlagsUsed(begin, end));
+	auto blockKey = std::make_tuple(hash, blockSizeByte, trailingFlagsUsed, statusFlagUsed);
 
 	//Don't use the cached blocks of we have a breakpoint in our block range.
 	bool hasBreakpoint = m_context.HasBreakpointInRange(begin, end);
@@ -48,7 +62,7 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 		//Check if we have a block that has the same contents but not the same range. Reuse the code of that block if that's the case.
 		if(beginBlockIterator != endBlockIterator)
 		{
-			auto result = std::make_shared<CVuBasicBlock>(context, begin, end, m_blockCategory);
+			auto result = std::make_shared<CVuBasicBlock>(context, begin, end, m_blockCategory, trailingFlagsUsed, statusFlagUsed);
 			result->CopyFunctionFrom(beginBlockIterator->second);
 			m_cachedBlocks.insert(std::make_pair(blockKey, result));
 			return result;
@@ -56,7 +70,7 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 	}
 
 	//Totally new block, build it from scratch
-	auto result = std::make_shared<CVuBasicBlock>(context, begin, end, m_blockCategory);
+	auto result = std::make_shared<CVuBasicBlock>(context, begin, end, m_blockCategory, trailingFlagsUsed, statusFlagUsed);
 	result->Compile();
 	if(!hasBreakpoint)
 	{
@@ -67,6 +81,8 @@ BasicBlockPtr CVuExecutor::BlockFactory(CMIPS& context, uint32 begin, uint32 end
 
 void CVuExecutor::PartitionFunction(uint32 startAddress)
 {
+	UpdateProgramFlagsUsage();
+
 	uint32 endAddress = std::min<uint32>(startAddress + MAX_BLOCK_SIZE - 4, m_maxAddress - 4);
 	uint32 branchAddress = MIPS_INVALID_PC;
 	for(uint32 address = startAddress; address < endAddress; address += 8)
@@ -101,3 +117,168 @@ void CVuExecutor::PartitionFunction(uint32 startAddress)
 		SetupBlockLinks(startAddress, endAddress, branchAddress);
 	}
 }
+
+void CVuExecutor::UpdateProgramFlagsUsage()
+{
+	if(m_flagsObservedExternally || !m_programFlagsUsageDirty) return;
+	m_programFlagsUsageDirty = false;
+
+	bool programReadsFlags = ProgramReadsFlags();
+	if(programReadsFlags == m_programReadsFlags) return;
+	m_programReadsFlags = programReadsFlags;
+
+	//Blocks that are still active were compiled with the wrong assumption about flag usage.
+	//This is only called when a new block is needed, no compiled block is executing at this point.
+	m_flagsDependencies.clear();
+	ClearActiveBlocksInRangeInternal(0, m_maxAddress, nullptr);
+}
+
+bool CVuExecutor::ProgramReadsFlags() const
+{
+	//Look at the whole micro memory, a block's flag results might be used by any other block
+	auto map = m_context.m_pMemoryMap->GetInstructionMap(0);
+	assert(map && ((map->nEnd + 1) >= m_maxAddress));
+	auto microMem = reinterpret_cast<const uint32*>(map->pPointer);
+	auto arch = static_cast<CMA_VU*>(m_context.m_pArch);
+	for(uint32 address = 0; address < m_maxAddress; address += 8)
+	{
+		uint32 opcodeLo = microMem[(address / 4) + 0];
+		uint32 opcodeHi = microMem[(address / 4) + 1];
+		//Lower word is an immediate value
+		if(opcodeHi & VUShared::VU_UPPEROP_BIT_I) continue;
+		//Flag instructions are in the contiguous opcode range 0x10 -> 0x1F inclusive
+		uint32 id = (opcodeLo >> 25) & 0x7F;
+		if((id < 0x10) || (id >= 0x20)) continue;
+		auto loOps = arch->GetAffectedOperands(&m_context, address, opcodeLo);
+		if(loOps.readMACflags) return true;
+	}
+	return false;
+}
+
+bool CVuExecutor::AreTrailingFlagsUsed(uint32 begin, uint32 end)
+{
+	//Check if the MAC flags produced at the end of a block can be read by the blocks that follow it
+	auto arch = static_cast<CMA_VU*>(m_context.m_pArch);
+
+	uint32 branchOpcodeAddr = end - 0xC;
+	if(branchOpcodeAddr < begin) return true;
+
+	uint32 branchOpcodeLo = m_context.m_pMemoryMap->GetInstruction(branchOpcodeAddr + 0);
+	uint32 branchOpcodeHi = m_context.m_pMemoryMap->GetInstruction(branchOpcodeAddr + 4);
+	uint32 delaySlotOpcodeLo = m_context.m_pMemoryMap->GetInstruction(end - 4);
+
+	//Microprogram ends here, flags persist and can be read by the next microprogram (FMAND, FMEQ, FSAND, etc.)
+	if(branchOpcodeHi & VUShared::VU_UPPEROP_BIT_E) return true;
+
+	//Branch in delay slot, too complicated to follow
+	if(arch->IsInstructionBranch(&m_context, end - 4, delaySlotOpcodeLo) != MIPS_BRANCH_NONE) return true;
+
+	std::vector<uint32> successors;
+	//Always consider the next instruction, it's also where subroutines called with BAL return to
+	successors.push_back(end + 4);
+	if(arch->IsInstructionBranch(&m_context, branchOpcodeAddr, branchOpcodeLo) == MIPS_BRANCH_NORMAL)
+	{
+		uint32 branchTarget = arch->GetInstructionEffectiveAddress(&m_context, branchOpcodeAddr, branchOpcodeLo);
+		//Target is only known at runtime (JR/JALR)
+		if(branchTarget == MIPS_INVALID_PC) return true;
+		successors.push_back(branchTarget);
+	}
+
+	FlagsDependencyArray dependencies;
+	for(auto successor : successors)
+	{
+		uint32 scanEnd = 0;
+		if(AreFlagsReadFrom(successor, scanEnd)) return true;
+		FLAGS_DEPENDENCY dependency;
+		dependency.blockBegin = begin;
+		dependency.rangeStart = successor;
+		dependency.rangeEnd = scanEnd;
+		dependencies.push_back(dependency);
+	}
+
+	for(const auto& dependency : dependencies)
+	{
+		//Don't register the same dependency twice if this block was already compiled before.
+		//Dependencies left by an older version of the block only cause extra invalidations.
+		auto range = m_flagsDependencies.equal_range(dependency.rangeStart);
+		bool found = std::any_of(range.first, range.second,
+		                         [&dependency](const FlagsDependencyMap::value_type& item) {
+			                         return (item.second.blockBegin == dependency.blockBegin) && (item.second.rangeEnd == dependency.rangeEnd);
+		                         });
+		if(found) continue;
+		m_flagsDependencies.insert(std::make_pair(dependency.rangeStart, dependency));
+	}
+	return false;
+}
+
+bool CVuExecutor::AreFlagsReadFrom(uint32 startAddress, uint32& scanEnd) const
+{
+	//Follow code until previous MAC results are overwritten or control flow gets too complicated.
+	//Stalls only make new results visible sooner, counting instructions is conservative.
+	auto arch = static_cast<CMA_VU*>(m_context.m_pArch);
+
+	uint32 firstWriteIndex = ~0U;
+	for(uint32 index = 0; index < MAX_FLAGS_SCAN_INSTRUCTIONS; index++)
+	{
+		uint32 address = startAddress + (index * 8);
+		if(address >= m_maxAddress) return true;
+		scanEnd = address + 8;
+
+		uint32 opcodeLo = m_context.m_pMemoryMap->GetInstruction(address + 0);
+		uint32 opcodeHi = m_context.m_pMemoryMap->GetInstruction(address + 4);
+		auto hiOps = arch->GetAffectedOperands(&m_context, address + 4, opcodeHi);
+
+		if((firstWriteIndex != ~0U) && (index >= (firstWriteIndex + VUShared::LATENCY_MAC)))
+		{
+			//Results we're interested in are not visible anymore
+			return false;
+		}
+
+		if((opcodeHi & VUShared::VU_UPPEROP_BIT_I) == 0)
+		{
+			auto loOps = arch->GetAffectedOperands(&m_context, address + 0, opcodeLo);
+			if(loOps.readMACflags) return true;
+			if(arch->IsInstructionBranch(&m_context, address, opcodeLo) != MIPS_BRANCH_NONE) return true;
+		}
+
+		if(hiOps.writeMACflags && (firstWriteIndex == ~0U))
+		{
+			firstWriteIndex = index;
+		}
+
+		if(opcodeHi & VUShared::VU_UPPEROP_BIT_E)
+		{
+			//Flags persist when the microprogram ends and can be read by the next one
+			return true;
+		}
+	}
+
+	return true;
+}
+
+void CVuExecutor::ClearFlagsDependentBlocks(uint32 start, uint32 end, bool executing)
+{
+	//Blocks that assumed their flags were not read by the code being invalidated need to be recompiled
+	//Scanned ranges are never longer than MAX_FLAGS_SCAN_INSTRUCTIONS, only look at those that can overlap
+	static const uint32 maxRangeSize = MAX_FLAGS_SCAN_INSTRUCTIONS * 8;
+	uint32 searchStart = (start > maxRangeSize) ? (start - maxRangeSize) : 0;
+	std::vector<uint32> dependentBlocks;
+	for(auto dependencyIterator = m_flagsDependencies.lower_bound(searchStart);
+	    (dependencyIterator != m_flagsDependencies.end()) && (dependencyIterator->first < end);)
+	{
+		const auto& dependency = dependencyIterator->second;
+		if(start < dependency.rangeEnd)
+		{
+			dependentBlocks.push_back(dependency.blockBegin);
+			dependencyIterator = m_flagsDependencies.erase(dependencyIterator);
+		}
+		else
+		{
+			dependencyIterator++;
+		}
+	}
+	for(auto blockBegin : dependentBlocks)
+	{
+		CGenericMipsExecutor::ClearActiveBlocksInRange(blockBegin, blockBegin + 4, executing);
+	}
+}
@@ -1,21 +1,51 @@
 #pragma once
 
 #include <map>
+#include <tuple>
+#include <vector>
 #include "../GenericMipsExecutor.h"
 
 class CVuExecutor : public CGenericMipsExecutor<BlockLookupOneWay, 8>
 {
 public:
-	CVuExecutor(CMIPS&, uint32);
+	CVuExecutor(CMIPS&, uint32, bool);
 	virtual ~CVuExecutor() = default;
 
 	void Reset() override;
+	void ClearActiveBlocksInRange(uint32, uint32, bool) override;
 
 protected:
-	typedef std::pair<uint128, uint32> CachedBlockKey;
+	typedef std::tuple<uint128, uint32, bool, bool> CachedBlockKey;
 	typedef std::multimap<CachedBlockKey, BasicBlockPtr> CachedBlockMap;
 	CachedBlockMap m_cachedBlocks;
 
 	BasicBlockPtr BlockFactory(CMIPS&, uint32, uint32) override;
 	void PartitionFunction(uint32) override;
+
+private:
+	//Block compiled with the assumption that the code in [rangeStart, rangeEnd[ doesn't read its flags
+	struct FLAGS_DEPENDENCY
+	{
+		uint32 blockBegin = 0;
+		uint32 rangeStart = 0;
+		uint32 rangeEnd = 0;
+	};
+	typedef std::vector<FLAGS_DEPENDENCY> FlagsDependencyArray;
+	//Indexed by rangeStart
+	typedef std::multimap<uint32, FLAGS_DEPENDENCY> FlagsDependencyMap;
+
+	//Maximum number of instructions looked at when following flag results
+	static const uint32 MAX_FLAGS_SCAN_INSTRUCTIONS = 16;
+
+	void UpdateProgramFlagsUsage();
+	bool ProgramReadsFlags() const;
+	bool AreTrailingFlagsUsed(uint32, uint32);
+	bool AreFlagsReadFrom(uint32, uint32&) const;
+	void ClearFlagsDependentBlocks(uint32, uint32, bool);
+
+	//Flags might be read by something else than the microprogram (ie.: VU0 in macro mode)
+	bool m_flagsObservedExternally = true;
+	bool m_programReadsFlags = true;
+	bool m_programFlagsUsageDirty = true;
+	FlagsDependencyMap m_flagsDependencies;
 };
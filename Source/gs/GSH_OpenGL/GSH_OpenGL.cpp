@@ -95,6 +95,7 @@ void CGSH_OpenGL::ReleaseImpl()
 	ResetImpl();
 
 	m_paletteCache.clear();
+	SaveShaderCache();
 	m_shaders.clear();
 	m_presentProgram.reset();
 	m_presentVertexBuffer.Reset();
@@ -103,10 +104,11 @@ void CGSH_OpenGL::ReleaseImpl()
 	m_copyToFbTexture.Reset();
 	m_copyToFbVertexBuffer.Reset();
 	m_copyToFbVertexArray.Reset();
-	m_primBuffer.Reset();
+	m_drawBatches.clear();
 	m_primVertexArray.Reset();
-	m_vertexParamsBuffer.Reset();
-	m_fragmentParamsBuffer.Reset();
+	m_primStreamBuffer.reset();
+	m_uniformStreamBuffer.reset();
+	m_framebufferUploadBuffer.reset();
 }
 
 void CGSH_OpenGL::ResetImpl()
@@ -117,6 +119,7 @@ void CGSH_OpenGL::ResetImpl()
 	m_framebuffers.clear();
 	m_depthbuffers.clear();
 	m_vertexBuffer.clear();
+	m_drawBatchCount = 0;
 	m_renderState.isValid = false;
 	m_validGlState = 0;
 	m_nVtxCount = 0;
@@ -128,7 +131,7 @@ void CGSH_OpenGL::ResetImpl()
 
 void CGSH_OpenGL::FlipImpl(const DISPLAY_INFO& dispInfo)
 {
-	FlushVertexBuffer();
+	FlushDrawBatches();
 	m_renderState.isValid = false;
 	m_validGlState = 0;
 
@@ -251,10 +254,12 @@ void CGSH_OpenGL::RegisterPreferences()
 	CGSHandler::RegisterPreferences();
 	CAppConfig::GetInstance().RegisterPreferenceInteger(PREF_CGSH_OPENGL_RESOLUTION_FACTOR, 1);
 	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES, false);
+	CAppConfig::GetInstance().RegisterPreferenceBoolean(PREF_CGSH_OPENGL_SHADERCACHE, true);
 }
 
 void CGSH_OpenGL::NotifyPreferencesChangedImpl()
 {
+	FlushDrawBatches();
 	LoadPreferences();
 	m_textureCache.Flush();
 	PalCache_Flush();
@@ -267,6 +272,7 @@ void CGSH_OpenGL::LoadPreferences()
 {
 	m_fbScale = CAppConfig::GetInstance().GetPreferenceInteger(PREF_CGSH_OPENGL_RESOLUTION_FACTOR);
 	m_forceBilinearTextures = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES);
+	m_shaderCacheEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSH_OPENGL_SHADERCACHE);
 }
 
 void CGSH_OpenGL::InitializeRC()
@@ -291,11 +297,16 @@ void CGSH_OpenGL::InitializeRC()
 	m_copyToFbSrcPositionUniform = glGetUniformLocation(*m_copyToFbProgram, "g_srcPosition");
 	m_copyToFbSrcSizeUniform = glGetUniformLocation(*m_copyToFbProgram, "g_srcSize");
 
-	m_primBuffer = Framework::OpenGl::CBuffer::Create();
+	m_primStreamBuffer = std::make_shared<CStreamBuffer>(GL_ARRAY_BUFFER, PRIM_STREAM_SEGMENT_SIZE, sizeof(PRIM_VERTEX), m_hasBufferStorageExtension);
 	m_primVertexArray = GeneratePrimVertexArray();
 
-	m_vertexParamsBuffer = GenerateUniformBlockBuffer(sizeof(VERTEXPARAMS));
-	m_fragmentParamsBuffer = GenerateUniformBlockBuffer(sizeof(FRAGMENTPARAMS));
+	m_uniformStreamBuffer = GenerateUniformStreamBuffer();
+
+	m_framebufferUploadBuffer = std::make_shared<CStreamBuffer>(GL_PIXEL_UNPACK_BUFFER, FRAMEBUFFER_UPLOAD_SEGMENT_SIZE, sizeof(uint32), m_hasBufferStorageExtension);
+	//Leaving a pixel unpack buffer bound would break uploads from client memory
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	LoadShaderCache();
 
 	PresentBackbuffer();
 
@@ -313,6 +324,25 @@ void CGSH_OpenGL::CheckExtensions()
 		{
 			m_hasFramebufferFetchExtension = true;
 		}
+		else if(!strcmp(extensionName, "GL_ARB_get_program_binary"))
+		{
+			m_hasProgramBinarySupport = true;
+		}
+		else if(!strcmp(extensionName, "GL_ARB_buffer_storage"))
+		{
+			m_hasBufferStorageExtension = true;
+		}
+	}
+#ifdef GLES_COMPATIBILITY
+	//Part of core OpenGL ES 3.0
+	m_hasProgramBinarySupport = true;
+#endif
+	if(m_hasProgramBinarySupport)
+	{
+		//Some drivers expose the entry points, but don't support any binary format
+		GLint numFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+		m_hasProgramBinarySupport = (numFormats != 0);
 	}
 }
 
@@ -417,7 +447,7 @@ Framework::OpenGl::CVertexArray CGSH_OpenGL::GeneratePrimVertexArray()
 
 	glBindVertexArray(vertexArray);
 
-	glBindBuffer(GL_ARRAY_BUFFER, m_primBuffer);
+	glBindBuffer(GL_ARRAY_BUFFER, *m_primStreamBuffer);
 
 	glEnableVertexAttribArray(static_cast<GLuint>(PRIM_VERTEX_ATTRIB::POSITION));
 	glVertexAttribPointer(static_cast<GLuint>(PRIM_VERTEX_ATTRIB::POSITION), 2, GL_FLOAT,
@@ -446,15 +476,14 @@ Framework::OpenGl::CVertexArray CGSH_OpenGL::GeneratePrimVertexArray()
 	return vertexArray;
 }
 
-Framework::OpenGl::CBuffer CGSH_OpenGL::GenerateUniformBlockBuffer(size_t blockSize)
+CGSH_OpenGL::StreamBufferPtr CGSH_OpenGL::GenerateUniformStreamBuffer()
 {
-	auto uniformBlockBuffer = Framework::OpenGl::CBuffer::Create();
-
-	glBindBuffer(GL_UNIFORM_BUFFER, uniformBlockBuffer);
-	glBufferData(GL_UNIFORM_BUFFER, blockSize, nullptr, GL_STREAM_DRAW);
+	GLint offsetAlignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offsetAlignment);
 	CHECKGLERROR();
 
-	return uniformBlockBuffer;
+	return std::make_shared<CStreamBuffer>(GL_UNIFORM_BUFFER, UNIFORM_STREAM_SEGMENT_SIZE,
+	                                       std::max<uint32>(offsetAlignment, 1), m_hasBufferStorageExtension);
 }
 
 void CGSH_OpenGL::MakeLinearZOrtho(float* matrix, float left, float right, float bottom, float top)
@@ -490,40 +519,45 @@ Framework::OpenGl::ProgramPtr CGSH_OpenGL::GetShaderFromCaps(const SHADERCAPS& s
 	if(shaderIterator == m_shaders.end())
 	{
 		auto shader = GenerateShader(shaderCaps);
+		shaderIterator = RegisterShader(shaderCaps, shader);
+	}
+	return shaderIterator->second;
+}
 
-		glUseProgram(*shader);
-		m_validGlState &= ~GLSTATE_PROGRAM;
-
-		auto textureUniform = glGetUniformLocation(*shader, "g_texture");
-		if(textureUniform != -1)
-		{
-			glUniform1i(textureUniform, 0);
-		}
+CGSH_OpenGL::ShaderMap::iterator CGSH_OpenGL::RegisterShader(const SHADERCAPS& shaderCaps, const Framework::OpenGl::ProgramPtr& shader)
+{
+	assert(m_shaders.find(shaderCaps) == m_shaders.end());
 
-		auto paletteUniform = glGetUniformLocation(*shader, "g_palette");
-		if(paletteUniform != -1)
-		{
-			glUniform1i(paletteUniform, 1);
-		}
+	glUseProgram(*shader);
+	m_validGlState &= ~GLSTATE_PROGRAM;
 
-		auto vertexParamsUniformBlock = glGetUniformBlockIndex(*shader, "VertexParams");
-		if(vertexParamsUniformBlock != GL_INVALID_INDEX)
-		{
-			glUniformBlockBinding(*shader, vertexParamsUniformBlock, 0);
-		}
+	auto textureUniform = glGetUniformLocation(*shader, "g_texture");
+	if(textureUniform != -1)
+	{
+		glUniform1i(textureUniform, 0);
+	}
 
-		auto fragmentParamsUniformBlock = glGetUniformBlockIndex(*shader, "FragmentParams");
-		if(fragmentParamsUniformBlock != GL_INVALID_INDEX)
-		{
-			glUniformBlockBinding(*shader, fragmentParamsUniformBlock, 1);
-		}
+	auto paletteUniform = glGetUniformLocation(*shader, "g_palette");
+	if(paletteUniform != -1)
+	{
+		glUniform1i(paletteUniform, 1);
+	}
 
-		CHECKGLERROR();
+	auto vertexParamsUniformBlock = glGetUniformBlockIndex(*shader, "VertexParams");
+	if(vertexParamsUniformBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(*shader, vertexParamsUniformBlock, 0);
+	}
 
-		m_shaders.insert(std::make_pair(shaderCaps, shader));
-		shaderIterator = m_shaders.find(shaderCaps);
+	auto fragmentParamsUniformBlock = glGetUniformBlockIndex(*shader, "FragmentParams");
+	if(fragmentParamsUniformBlock != GL_INVALID_INDEX)
+	{
+		glUniformBlockBinding(*shader, fragmentParamsUniformBlock, 1);
 	}
-	return shaderIterator->second;
+
+	CHECKGLERROR();
+
+	return m_shaders.insert(std::make_pair(shaderCaps, shader)).first;
 }
 
 void CGSH_OpenGL::SetRenderingContext(uint64 primReg)
@@ -679,208 +713,217 @@ void CGSH_OpenGL::SetupBlendingFunction(uint64 alphaReg)
 		return;
 	}
 
-	int nFunction = GL_FUNC_ADD;
+	auto setBlendFactors = [this](GLenum srcFactor, GLenum dstFactor) {
+		m_renderState.blendSrcFactor = srcFactor;
+		m_renderState.blendDstFactor = dstFactor;
+	};
+
+	//Blend color is only relevant for some functions, reset it to avoid needless state mismatches
+	m_renderState.blendColorAlpha = 0;
+
+	GLenum nFunction = GL_FUNC_ADD;
 	if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//ab*0 (when a == b) - Cs
-		glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ONE, GL_ZERO);
 	}
 	else if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//ab*1 (when a == b) - Cd
-		glBlendFuncSeparate(GL_ZERO, GL_ONE, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ZERO, GL_ONE);
 	}
 	else if((alpha.nA == alpha.nB) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//ab*2 (when a == b) - Zero
-		glBlendFuncSeparate(GL_ZERO, GL_ZERO, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ZERO, GL_ZERO);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CS) && (alpha.nB == ALPHABLEND_ABD_CD) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//0101 - Cs * As + Cd * (1 - As)
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, BLEND_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(BLEND_SRC_ALPHA, BLEND_ONE_MINUS_SRC_ALPHA);
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 1) && (alpha.nC == 1) && (alpha.nD == 1))
 	{
 		//Cs * Ad + Cd * (1 - Ad)
-		glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE_MINUS_DST_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_DST_ALPHA, GL_ONE_MINUS_DST_ALPHA);
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 1) && (alpha.nC == 2) && (alpha.nD == 1))
 	{
 		if(alpha.nFix == 0x80)
 		{
-			glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+			setBlendFactors(GL_ONE, GL_ZERO);
 		}
 		else
 		{
 			//Source alpha value is implied in the formula
 			//As = FIX / 0x80
-			glBlendColor(0.0f, 0.0f, 0.0f, (float)alpha.nFix / 128.0f);
-			glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+			m_renderState.blendColorAlpha = (float)alpha.nFix / 128.0f;
+			setBlendFactors(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
 		}
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 1))
 	{
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		setBlendFactors(BLEND_SRC_ALPHA, GL_ONE);
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 2))
 	{
 		//Cs * As
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, GL_ZERO, GL_ONE, GL_ZERO);
+		setBlendFactors(BLEND_SRC_ALPHA, GL_ZERO);
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 1) && (alpha.nD == 1))
 	{
 		//Cs * Ad + Cd
-		glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_DST_ALPHA, GL_ONE);
 	}
 	else if((alpha.nA == 0) && (alpha.nB == 2) && (alpha.nC == 2) && (alpha.nD == 1))
 	{
 		if(alpha.nFix == 0x80)
 		{
-			glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ZERO);
+			setBlendFactors(GL_ONE, GL_ONE);
 		}
 		else
 		{
 			//Cs * FIX + Cd
-			glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-			glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+			m_renderState.blendColorAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+			setBlendFactors(GL_CONSTANT_ALPHA, GL_ONE);
 		}
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CS) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//0222 - Cs * FIX
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ZERO, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		setBlendFactors(GL_CONSTANT_ALPHA, GL_ZERO);
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 0) && (alpha.nC == 0) && (alpha.nD == 0))
 	{
 		//(Cd - Cs) * As + Cs
-		glBlendFuncSeparate(BLEND_ONE_MINUS_SRC_ALPHA, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(BLEND_ONE_MINUS_SRC_ALPHA, BLEND_SRC_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1001 -> (Cd - Cs) * As + Cd (Inaccurate, needs +1 to As)
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(BLEND_SRC_ALPHA, BLEND_SRC_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//1002 -> (Cd - Cs) * As
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(BLEND_SRC_ALPHA, BLEND_SRC_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1010 -> Cs * (1 - Ad) + Cd * Ad
-		glBlendFuncSeparate(GL_ONE_MINUS_DST_ALPHA, GL_DST_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ONE_MINUS_DST_ALPHA, GL_DST_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1020 -> Cs * (1 - FIX) + Cd * FIX
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ONE_MINUS_CONSTANT_ALPHA, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		setBlendFactors(GL_ONE_MINUS_CONSTANT_ALPHA, GL_CONSTANT_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1021 -> (Cd - Cs) * FIX + Cd
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendColor(0.0f, 0.0f, 0.0f, (float)alpha.nFix / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = (float)alpha.nFix / 128.0f;
+		setBlendFactors(GL_CONSTANT_ALPHA, GL_ONE);
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 0) && (alpha.nC == 2) && (alpha.nD == 2))
 	{
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendColor(0.0f, 0.0f, 0.0f, (float)alpha.nFix / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = (float)alpha.nFix / 128.0f;
+		setBlendFactors(GL_CONSTANT_ALPHA, GL_CONSTANT_ALPHA);
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 2) && (alpha.nC == 0) && (alpha.nD == 0))
 	{
 		//Cd * As + Cs
-		glBlendFuncSeparate(GL_ONE, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ONE, BLEND_SRC_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1201 -> Cd * (As + 1)
 		//Relies on colorOutputWhite shader cap
-		glBlendFuncSeparate(GL_DST_COLOR, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_DST_COLOR, BLEND_SRC_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//1202 - Cd * As
-		glBlendFuncSeparate(GL_ZERO, BLEND_SRC_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ZERO, BLEND_SRC_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1210 - Cs + (Cd * Ad)
-		glBlendFuncSeparate(GL_ONE, GL_DST_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ONE, GL_DST_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_ZERO))
 	{
 		//1212 - Cd * Ad
-		glBlendFuncSeparate(GL_ZERO, GL_DST_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ZERO, GL_DST_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//1220 -> Cd * FIX + Cs
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ONE, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		setBlendFactors(GL_ONE, GL_CONSTANT_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_CD) && (alpha.nB == ALPHABLEND_ABD_ZERO) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//1221 -> Cd * (1 + FIX)
 		//Relies on colorOutputWhite shader cap
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_DST_COLOR, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		setBlendFactors(GL_DST_COLOR, GL_CONSTANT_ALPHA);
 	}
 	else if((alpha.nA == 1) && (alpha.nB == 2) && (alpha.nC == 2) && (alpha.nD == 2))
 	{
 		//1222 -> Cd * FIX
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ZERO, GL_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		setBlendFactors(GL_ZERO, GL_CONSTANT_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CS))
 	{
 		//2000 -> Cs * (1 - As)
-		glBlendFuncSeparate(BLEND_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE, GL_ZERO);
+		setBlendFactors(BLEND_ONE_MINUS_SRC_ALPHA, GL_ZERO);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2001 -> Cd - Cs * As
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(BLEND_SRC_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		setBlendFactors(BLEND_SRC_ALPHA, GL_ONE);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_AD) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2011 -> Cd - Cs * Ad
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendFuncSeparate(GL_DST_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_DST_ALPHA, GL_ONE);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CS) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2021 -> Cd - Cs * FIX
 		nFunction = GL_FUNC_REVERSE_SUBTRACT;
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_CONSTANT_ALPHA, GL_ONE, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		setBlendFactors(GL_CONSTANT_ALPHA, GL_ONE);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CD) && (alpha.nC == ALPHABLEND_C_AS) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2101 -> Cd * (1 - As)
-		glBlendFuncSeparate(GL_ZERO, BLEND_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ZERO, BLEND_ONE_MINUS_SRC_ALPHA);
 	}
 	else if((alpha.nA == ALPHABLEND_ABD_ZERO) && (alpha.nB == ALPHABLEND_ABD_CD) && (alpha.nC == ALPHABLEND_C_FIX) && (alpha.nD == ALPHABLEND_ABD_CD))
 	{
 		//2121 -> Cd * (1 - FIX)
-		glBlendColor(0, 0, 0, static_cast<float>(alpha.nFix) / 128.0f);
-		glBlendFuncSeparate(GL_ZERO, GL_ONE_MINUS_CONSTANT_ALPHA, GL_ONE, GL_ZERO);
+		m_renderState.blendColorAlpha = static_cast<float>(alpha.nFix) / 128.0f;
+		setBlendFactors(GL_ZERO, GL_ONE_MINUS_CONSTANT_ALPHA);
 	}
 	else
 	{
 		assert(0);
 		//Default blending
-		glBlendFuncSeparate(GL_ONE, GL_ZERO, GL_ONE, GL_ZERO);
+		setBlendFactors(GL_ONE, GL_ZERO);
 	}
 
-	glBlendEquationSeparate(nFunction, GL_FUNC_ADD);
+	m_renderState.blendEquation = nFunction;
+	m_validGlState &= ~GLSTATE_BLEND;
 }
 
 void CGSH_OpenGL::SetupTestFunctions(uint64 testReg)
@@ -891,11 +934,12 @@ void CGSH_OpenGL::SetupTestFunctions(uint64 testReg)
 	m_validGlState &= ~GLSTATE_FRAGMENT_PARAMS;
 
 	m_renderState.depthTest = (test.nDepthEnabled != 0) && m_depthTestingEnabled;
+	m_renderState.depthFunc = GL_ALWAYS;
 	m_validGlState &= ~GLSTATE_DEPTHTEST;
 
 	if(test.nDepthEnabled)
 	{
-		unsigned int nFunc = GL_NEVER;
+		GLenum nFunc = GL_NEVER;
 
 		switch(test.nDepthMethod)
 		{
@@ -913,7 +957,7 @@ void CGSH_OpenGL::SetupTestFunctions(uint64 testReg)
 			break;
 		}
 
-		glDepthFunc(nFunc);
+		m_renderState.depthFunc = nFunc;
 	}
 }
 
@@ -1000,26 +1044,16 @@ void CGSH_OpenGL::SetupFramebuffer(uint64 frameReg, uint64 zbufReg, uint64 sciss
 
 	assert(framebuffer->m_width == depthbuffer->m_width);
 
-	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->m_framebuffer);
-
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthbuffer->m_depthBuffer);
-	CHECKGLERROR();
-
-	assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
-
+	//Framebuffer will be bound and depth buffer attached when batches using it are drawn
 	m_renderState.framebufferHandle = framebuffer->m_framebuffer;
-	m_validGlState |= GLSTATE_FRAMEBUFFER; //glBindFramebuffer used to set just above
+	m_renderState.framebufferTextureHandle = framebuffer->m_texture;
+	m_renderState.depthbufferHandle = depthbuffer->m_depthBuffer;
+	m_validGlState &= ~GLSTATE_FRAMEBUFFER;
 
 	//We assume that we will be drawing to this framebuffer and that we'll need
 	//to resolve samples at some point if multisampling is enabled
 	framebuffer->m_resolveNeeded = true;
 
-	{
-		GLenum drawBufferId = GL_COLOR_ATTACHMENT0;
-		glDrawBuffers(1, &drawBufferId);
-		CHECKGLERROR();
-	}
-
 	m_renderState.viewportWidth = framebuffer->m_width;
 	m_renderState.viewportHeight = framebuffer->m_height;
 	m_validGlState &= ~GLSTATE_VIEWPORT;
@@ -1183,6 +1217,7 @@ void CGSH_OpenGL::SetupTexture(uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, u
 	m_renderState.texture0MagFilter = GL_NEAREST;
 	m_renderState.texture0WrapS = GL_CLAMP_TO_EDGE;
 	m_renderState.texture0WrapT = GL_CLAMP_TO_EDGE;
+	m_renderState.texture0IsFramebuffer = false;
 	m_validGlState &= ~GLSTATE_TEXTURE;
 
 	auto prim = make_convertible<PRMODE>(primReg);
@@ -1203,6 +1238,7 @@ void CGSH_OpenGL::SetupTexture(uint64 primReg, uint64 tex0Reg, uint64 tex1Reg, u
 	auto texInfo = PrepareTexture(tex0);
 	m_renderState.texture0Handle = texInfo.textureHandle;
 	m_renderState.texture0AlphaAsIndex = texInfo.alphaAsIndex;
+	m_renderState.texture0IsFramebuffer = texInfo.isFramebuffer;
 
 	//Setup sampling modes
 	switch(tex1.nMagFilter)
@@ -1649,137 +1685,359 @@ void CGSH_OpenGL::FlushVertexBuffer()
 	assert(m_renderState.isValid == true);
 
 	auto shader = GetShaderFromCaps(m_renderState.shaderCaps);
-	if(*shader != m_renderState.shaderHandle)
+	m_renderState.shaderHandle = *shader;
+
+	GLenum primitiveMode = GL_NONE;
+	switch(m_primitiveType)
+	{
+	case PRIM_POINT:
+		primitiveMode = GL_POINTS;
+		break;
+	case PRIM_LINE:
+	case PRIM_LINESTRIP:
+		primitiveMode = GL_LINES;
+		break;
+	case PRIM_TRIANGLE:
+	case PRIM_TRIANGLESTRIP:
+	case PRIM_TRIANGLEFAN:
+	case PRIM_SPRITE:
+		primitiveMode = GL_TRIANGLES;
+		break;
+	default:
+		assert(false);
+		break;
+	}
+
+	auto bounds = GetVertexBufferBounds();
+	if(auto mergeBatch = FindMergeableDrawBatch(primitiveMode, bounds))
+	{
+		mergeBatch->vertices.insert(mergeBatch->vertices.end(), m_vertexBuffer.begin(), m_vertexBuffer.end());
+		mergeBatch->drawRegion.Insert(bounds);
+		m_vertexBuffer.clear();
+		return;
+	}
+
+	if(m_drawBatchCount == MAX_DRAW_BATCHES)
 	{
-		m_renderState.shaderHandle = *shader;
-		m_validGlState &= ~GLSTATE_PROGRAM;
+		SubmitDrawBatches();
 	}
-	DoRenderPass();
+
+	//Batches are recycled to keep the capacity of their vertex buffers
+	if(m_drawBatchCount == m_drawBatches.size())
+	{
+		m_drawBatches.emplace_back();
+	}
+	auto& batch = m_drawBatches[m_drawBatchCount++];
+	batch.renderState = m_renderState;
+	batch.vertexParams = m_vertexParams;
+	batch.fragmentParams = m_fragmentParams;
+	batch.primitiveMode = primitiveMode;
+	//Moving a batch over draws that read from a framebuffer could change what they read
+	batch.canMerge = !m_renderState.texture0IsFramebuffer;
+	batch.vertices.assign(m_vertexBuffer.begin(), m_vertexBuffer.end());
+	batch.drawRegion.Reset();
+	batch.drawRegion.Insert(bounds);
 	m_vertexBuffer.clear();
 }
 
-void CGSH_OpenGL::DoRenderPass()
+void CGSH_OpenGL::FlushDrawBatches()
+{
+	FlushVertexBuffer();
+	SubmitDrawBatches();
+}
+
+void CGSH_OpenGL::SubmitDrawBatches()
+{
+	for(uint32 i = 0; i < m_drawBatchCount; i++)
+	{
+		DoRenderPass(m_drawBatches[i]);
+	}
+	m_drawBatchCount = 0;
+}
+
+CGSH_OpenGL::DRAW_BATCH* CGSH_OpenGL::FindMergeableDrawBatch(GLenum primitiveMode, const CGsSpriteRect& bounds)
+{
+	if(m_renderState.texture0IsFramebuffer) return nullptr;
+
+	//Appending our vertices to an older batch moves them before every batch recorded after it.
+	//This is fine as long as none of those touch the same pixels in our framebuffer or depth buffer.
+	uint32 lookbackEnd = (m_drawBatchCount > DRAW_BATCH_MERGE_LOOKBACK) ? (m_drawBatchCount - DRAW_BATCH_MERGE_LOOKBACK) : 0;
+	for(uint32 i = m_drawBatchCount; i > lookbackEnd; i--)
+	{
+		auto& batch = m_drawBatches[i - 1];
+		//Batches sampling our framebuffer must see its contents before our draw
+		bool samplesTarget = batch.renderState.texture0IsFramebuffer &&
+		                     (batch.renderState.texture0Handle == m_renderState.framebufferTextureHandle);
+		if(samplesTarget)
+		{
+			return nullptr;
+		}
+		if(batch.canMerge && IsSameDrawState(batch, primitiveMode))
+		{
+			return &batch;
+		}
+		bool sharesTarget =
+		    (batch.renderState.framebufferHandle == m_renderState.framebufferHandle) ||
+		    (batch.renderState.depthbufferHandle == m_renderState.depthbufferHandle);
+		if(sharesTarget && batch.drawRegion.Intersects(bounds))
+		{
+			return nullptr;
+		}
+	}
+	return nullptr;
+}
+
+bool CGSH_OpenGL::IsSameDrawState(const DRAW_BATCH& batch, GLenum primitiveMode) const
+{
+	return (batch.primitiveMode == primitiveMode) &&
+	       IsSameGlState(batch.renderState, m_renderState) &&
+	       (memcmp(&batch.vertexParams, &m_vertexParams, sizeof(VERTEXPARAMS)) == 0) &&
+	       (memcmp(&batch.fragmentParams, &m_fragmentParams, sizeof(FRAGMENTPARAMS)) == 0);
+}
+
+bool CGSH_OpenGL::IsSameGlState(const RENDERSTATE& lhs, const RENDERSTATE& rhs)
+{
+	return (lhs.shaderHandle == rhs.shaderHandle) &&
+	       (lhs.framebufferHandle == rhs.framebufferHandle) &&
+	       (lhs.depthbufferHandle == rhs.depthbufferHandle) &&
+	       (lhs.texture0Handle == rhs.texture0Handle) &&
+	       (lhs.texture0MinFilter == rhs.texture0MinFilter) &&
+	       (lhs.texture0MagFilter == rhs.texture0MagFilter) &&
+	       (lhs.texture0WrapS == rhs.texture0WrapS) &&
+	       (lhs.texture0WrapT == rhs.texture0WrapT) &&
+	       (lhs.texture0AlphaAsIndex == rhs.texture0AlphaAsIndex) &&
+	       (lhs.texture1Handle == rhs.texture1Handle) &&
+	       (lhs.viewportWidth == rhs.viewportWidth) &&
+	       (lhs.viewportHeight == rhs.viewportHeight) &&
+	       (lhs.scissorX == rhs.scissorX) &&
+	       (lhs.scissorY == rhs.scissorY) &&
+	       (lhs.scissorWidth == rhs.scissorWidth) &&
+	       (lhs.scissorHeight == rhs.scissorHeight) &&
+	       (lhs.blendEnabled == rhs.blendEnabled) &&
+	       (lhs.blendSrcFactor == rhs.blendSrcFactor) &&
+	       (lhs.blendDstFactor == rhs.blendDstFactor) &&
+	       (lhs.blendEquation == rhs.blendEquation) &&
+	       (lhs.blendColorAlpha == rhs.blendColorAlpha) &&
+	       (lhs.colorMaskR == rhs.colorMaskR) &&
+	       (lhs.colorMaskG == rhs.colorMaskG) &&
+	       (lhs.colorMaskB == rhs.colorMaskB) &&
+	       (lhs.colorMaskA == rhs.colorMaskA) &&
+	       (lhs.depthMask == rhs.depthMask) &&
+	       (lhs.depthTest == rhs.depthTest) &&
+	       (lhs.depthFunc == rhs.depthFunc);
+}
+
+CGsSpriteRect CGSH_OpenGL::GetVertexBufferBounds() const
+{
+	assert(!m_vertexBuffer.empty());
+	float minX = m_vertexBuffer[0].x;
+	float minY = m_vertexBuffer[0].y;
+	float maxX = minX;
+	float maxY = minY;
+	for(const auto& vertex : m_vertexBuffer)
+	{
+		minX = std::min(minX, vertex.x);
+		minY = std::min(minY, vertex.y);
+		maxX = std::max(maxX, vertex.x);
+		maxY = std::max(maxY, vertex.y);
+	}
+	//Points and lines have no area but still cover pixels
+	return CGsSpriteRect(minX, minY, maxX + 1, maxY + 1);
+}
+
+void CGSH_OpenGL::DoRenderPass(const DRAW_BATCH& batch)
 {
-	if((m_validGlState & GLSTATE_VERTEX_PARAMS) == 0)
+	const auto& renderState = batch.renderState;
+	auto& appliedState = m_appliedRenderState;
+
+	//Make sure both blocks fit in the same segment. If we moved to another segment,
+	//previously written blocks might be overwritten soon and need to be written again.
+	m_uniformStreamBuffer->Reserve(sizeof(VERTEXPARAMS) + sizeof(FRAGMENTPARAMS));
+	if(m_uniformStreamBuffer->GetSegmentSerial() != m_uniformStreamSegmentSerial)
+	{
+		m_uniformStreamSegmentSerial = m_uniformStreamBuffer->GetSegmentSerial();
+		m_validGlState &= ~(GLSTATE_VERTEX_PARAMS | GLSTATE_FRAGMENT_PARAMS);
+	}
+
+	if(((m_validGlState & GLSTATE_VERTEX_PARAMS) == 0) ||
+	   (memcmp(&m_appliedVertexParams, &batch.vertexParams, sizeof(VERTEXPARAMS)) != 0))
 	{
-		glBindBuffer(GL_UNIFORM_BUFFER, m_vertexParamsBuffer);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(VERTEXPARAMS), &m_vertexParams, GL_STREAM_DRAW);
+		m_vertexParamsOffset = m_uniformStreamBuffer->Write(&batch.vertexParams, sizeof(VERTEXPARAMS));
 		CHECKGLERROR();
+		m_appliedVertexParams = batch.vertexParams;
 		m_validGlState |= GLSTATE_VERTEX_PARAMS;
 	}
 
-	if((m_validGlState & GLSTATE_FRAGMENT_PARAMS) == 0)
+	if(((m_validGlState & GLSTATE_FRAGMENT_PARAMS) == 0) ||
+	   (memcmp(&m_appliedFragmentParams, &batch.fragmentParams, sizeof(FRAGMENTPARAMS)) != 0))
 	{
-		glBindBuffer(GL_UNIFORM_BUFFER, m_fragmentParamsBuffer);
-		glBufferData(GL_UNIFORM_BUFFER, sizeof(FRAGMENTPARAMS), &m_fragmentParams, GL_STREAM_DRAW);
+		m_fragmentParamsOffset = m_uniformStreamBuffer->Write(&batch.fragmentParams, sizeof(FRAGMENTPARAMS));
 		CHECKGLERROR();
+		m_appliedFragmentParams = batch.fragmentParams;
 		m_validGlState |= GLSTATE_FRAGMENT_PARAMS;
 	}
 
-	if((m_validGlState & GLSTATE_PROGRAM) == 0)
+	if(((m_validGlState & GLSTATE_PROGRAM) == 0) ||
+	   (appliedState.shaderHandle != renderState.shaderHandle))
 	{
-		glUseProgram(m_renderState.shaderHandle);
+		glUseProgram(renderState.shaderHandle);
+		appliedState.shaderHandle = renderState.shaderHandle;
 		m_validGlState |= GLSTATE_PROGRAM;
 	}
 
-	if((m_validGlState & GLSTATE_VIEWPORT) == 0)
+	if(((m_validGlState & GLSTATE_VIEWPORT) == 0) ||
+	   (appliedState.viewportWidth != renderState.viewportWidth) ||
+	   (appliedState.viewportHeight != renderState.viewportHeight))
 	{
-		glViewport(0, 0, m_renderState.viewportWidth * m_fbScale, m_renderState.viewportHeight * m_fbScale);
+		glViewport(0, 0, renderState.viewportWidth * m_fbScale, renderState.viewportHeight * m_fbScale);
+		appliedState.viewportWidth = renderState.viewportWidth;
+		appliedState.viewportHeight = renderState.viewportHeight;
 		m_validGlState |= GLSTATE_VIEWPORT;
 	}
 
-	if((m_validGlState & GLSTATE_SCISSOR) == 0)
+	if(((m_validGlState & GLSTATE_SCISSOR) == 0) ||
+	   (appliedState.scissorX != renderState.scissorX) ||
+	   (appliedState.scissorY != renderState.scissorY) ||
+	   (appliedState.scissorWidth != renderState.scissorWidth) ||
+	   (appliedState.scissorHeight != renderState.scissorHeight))
 	{
 		glEnable(GL_SCISSOR_TEST);
-		glScissor(m_renderState.scissorX * m_fbScale, m_renderState.scissorY * m_fbScale,
-		          m_renderState.scissorWidth * m_fbScale, m_renderState.scissorHeight * m_fbScale);
+		glScissor(renderState.scissorX * m_fbScale, renderState.scissorY * m_fbScale,
+		          renderState.scissorWidth * m_fbScale, renderState.scissorHeight * m_fbScale);
+		appliedState.scissorX = renderState.scissorX;
+		appliedState.scissorY = renderState.scissorY;
+		appliedState.scissorWidth = renderState.scissorWidth;
+		appliedState.scissorHeight = renderState.scissorHeight;
 		m_validGlState |= GLSTATE_SCISSOR;
 	}
 
-	if((m_validGlState & GLSTATE_BLEND) == 0)
+	if(((m_validGlState & GLSTATE_BLEND) == 0) ||
+	   (appliedState.blendEnabled != renderState.blendEnabled) ||
+	   (appliedState.blendSrcFactor != renderState.blendSrcFactor) ||
+	   (appliedState.blendDstFactor != renderState.blendDstFactor) ||
+	   (appliedState.blendEquation != renderState.blendEquation) ||
+	   (appliedState.blendColorAlpha != renderState.blendColorAlpha))
 	{
-		m_renderState.blendEnabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+		renderState.blendEnabled ? glEnable(GL_BLEND) : glDisable(GL_BLEND);
+		if(!m_hasFramebufferFetchExtension)
+		{
+			glBlendFuncSeparate(renderState.blendSrcFactor, renderState.blendDstFactor, GL_ONE, GL_ZERO);
+			glBlendEquationSeparate(renderState.blendEquation, GL_FUNC_ADD);
+			glBlendColor(0, 0, 0, renderState.blendColorAlpha);
+		}
+		appliedState.blendEnabled = renderState.blendEnabled;
+		appliedState.blendSrcFactor = renderState.blendSrcFactor;
+		appliedState.blendDstFactor = renderState.blendDstFactor;
+		appliedState.blendEquation = renderState.blendEquation;
+		appliedState.blendColorAlpha = renderState.blendColorAlpha;
 		m_validGlState |= GLSTATE_BLEND;
 	}
 
-	if((m_validGlState & GLSTATE_DEPTHTEST) == 0)
+	if(((m_validGlState & GLSTATE_DEPTHTEST) == 0) ||
+	   (appliedState.depthTest != renderState.depthTest) ||
+	   (appliedState.depthFunc != renderState.depthFunc))
 	{
-		m_renderState.depthTest ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+		renderState.depthTest ? glEnable(GL_DEPTH_TEST) : glDisable(GL_DEPTH_TEST);
+		glDepthFunc(renderState.depthFunc);
+		appliedState.depthTest = renderState.depthTest;
+		appliedState.depthFunc = renderState.depthFunc;
 		m_validGlState |= GLSTATE_DEPTHTEST;
 	}
 
-	if((m_validGlState & GLSTATE_COLORMASK) == 0)
+	if(((m_validGlState & GLSTATE_COLORMASK) == 0) ||
+	   (appliedState.colorMaskR != renderState.colorMaskR) ||
+	   (appliedState.colorMaskG != renderState.colorMaskG) ||
+	   (appliedState.colorMaskB != renderState.colorMaskB) ||
+	   (appliedState.colorMaskA != renderState.colorMaskA))
 	{
 		glColorMask(
-		    m_renderState.colorMaskR, m_renderState.colorMaskG,
-		    m_renderState.colorMaskB, m_renderState.colorMaskA);
+		    renderState.colorMaskR, renderState.colorMaskG,
+		    renderState.colorMaskB, renderState.colorMaskA);
+		appliedState.colorMaskR = renderState.colorMaskR;
+		appliedState.colorMaskG = renderState.colorMaskG;
+		appliedState.colorMaskB = renderState.colorMaskB;
+		appliedState.colorMaskA = renderState.colorMaskA;
 		m_validGlState |= GLSTATE_COLORMASK;
 	}
 
-	if((m_validGlState & GLSTATE_DEPTHMASK) == 0)
+	if(((m_validGlState & GLSTATE_DEPTHMASK) == 0) ||
+	   (appliedState.depthMask != renderState.depthMask))
 	{
-		glDepthMask(m_renderState.depthMask ? GL_TRUE : GL_FALSE);
+		glDepthMask(renderState.depthMask ? GL_TRUE : GL_FALSE);
+		appliedState.depthMask = renderState.depthMask;
 		m_validGlState |= GLSTATE_DEPTHMASK;
 	}
 
-	if((m_validGlState & GLSTATE_TEXTURE) == 0)
+	if(((m_validGlState & GLSTATE_TEXTURE) == 0) ||
+	   (appliedState.texture0Handle != renderState.texture0Handle) ||
+	   (appliedState.texture0MinFilter != renderState.texture0MinFilter) ||
+	   (appliedState.texture0MagFilter != renderState.texture0MagFilter) ||
+	   (appliedState.texture0WrapS != renderState.texture0WrapS) ||
+	   (appliedState.texture0WrapT != renderState.texture0WrapT) ||
+	   (appliedState.texture0AlphaAsIndex != renderState.texture0AlphaAsIndex) ||
+	   (appliedState.texture1Handle != renderState.texture1Handle))
 	{
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, m_renderState.texture0Handle);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_renderState.texture0MinFilter);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_renderState.texture0MagFilter);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, m_renderState.texture0WrapS);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, m_renderState.texture0WrapT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, m_renderState.texture0AlphaAsIndex ? GL_ALPHA : GL_RED);
+		glBindTexture(GL_TEXTURE_2D, renderState.texture0Handle);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, renderState.texture0MinFilter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, renderState.texture0MagFilter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, renderState.texture0WrapS);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, renderState.texture0WrapT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, renderState.texture0AlphaAsIndex ? GL_ALPHA : GL_RED);
 
 		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, m_renderState.texture1Handle);
+		glBindTexture(GL_TEXTURE_2D, renderState.texture1Handle);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+		appliedState.texture0Handle = renderState.texture0Handle;
+		appliedState.texture0MinFilter = renderState.texture0MinFilter;
+		appliedState.texture0MagFilter = renderState.texture0MagFilter;
+		appliedState.texture0WrapS = renderState.texture0WrapS;
+		appliedState.texture0WrapT = renderState.texture0WrapT;
+		appliedState.texture0AlphaAsIndex = renderState.texture0AlphaAsIndex;
+		appliedState.texture1Handle = renderState.texture1Handle;
 		m_validGlState |= GLSTATE_TEXTURE;
 	}
 
-	if((m_validGlState & GLSTATE_FRAMEBUFFER) == 0)
+	if(((m_validGlState & GLSTATE_FRAMEBUFFER) == 0) ||
+	   (appliedState.framebufferHandle != renderState.framebufferHandle) ||
+	   (appliedState.depthbufferHandle != renderState.depthbufferHandle))
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, m_renderState.framebufferHandle);
+		glBindFramebuffer(GL_FRAMEBUFFER, renderState.framebufferHandle);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, renderState.depthbufferHandle);
+		CHECKGLERROR();
+
+		assert(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+
+		GLenum drawBufferId = GL_COLOR_ATTACHMENT0;
+		glDrawBuffers(1, &drawBufferId);
+		CHECKGLERROR();
+
+		appliedState.framebufferHandle = renderState.framebufferHandle;
+		appliedState.depthbufferHandle = renderState.depthbufferHandle;
 		m_validGlState |= GLSTATE_FRAMEBUFFER;
 	}
 
-	glBindBufferBase(GL_UNIFORM_BUFFER, 0, m_vertexParamsBuffer);
-	glBindBufferBase(GL_UNIFORM_BUFFER, 1, m_fragmentParamsBuffer);
-
-	glBindBuffer(GL_ARRAY_BUFFER, m_primBuffer);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(PRIM_VERTEX) * m_vertexBuffer.size(), m_vertexBuffer.data(), GL_STREAM_DRAW);
+	glBindBufferRange(GL_UNIFORM_BUFFER, 0, *m_uniformStreamBuffer, m_vertexParamsOffset, sizeof(VERTEXPARAMS));
+	glBindBufferRange(GL_UNIFORM_BUFFER, 1, *m_uniformStreamBuffer, m_fragmentParamsOffset, sizeof(FRAGMENTPARAMS));
 
 	glBindVertexArray(m_primVertexArray);
 
-	GLenum primitiveMode = GL_NONE;
-	switch(m_primitiveType)
+	//Batches bigger than a stream buffer segment are split. Chunk size is a multiple of
+	//every primitive's vertex count (1, 2 and 3) to make sure we never split a primitive.
+	static const uint32 maxChunkVertexCount = (PRIM_STREAM_SEGMENT_SIZE / sizeof(PRIM_VERTEX)) / 6 * 6;
+	uint32 vertexCount = batch.vertices.size();
+	for(uint32 vertexStart = 0; vertexStart < vertexCount;)
 	{
-	case PRIM_POINT:
-		primitiveMode = GL_POINTS;
-		break;
-	case PRIM_LINE:
-	case PRIM_LINESTRIP:
-		primitiveMode = GL_LINES;
-		break;
-	case PRIM_TRIANGLE:
-	case PRIM_TRIANGLESTRIP:
-	case PRIM_TRIANGLEFAN:
-	case PRIM_SPRITE:
-		primitiveMode = GL_TRIANGLES;
-		break;
-	default:
-		assert(false);
-		break;
+		uint32 chunkVertexCount = std::min(vertexCount - vertexStart, maxChunkVertexCount);
+		uint32 chunkOffset = m_primStreamBuffer->Write(batch.vertices.data() + vertexStart, sizeof(PRIM_VERTEX) * chunkVertexCount);
+		glDrawArrays(batch.primitiveMode, chunkOffset / sizeof(PRIM_VERTEX), chunkVertexCount);
+		vertexStart += chunkVertexCount;
+		m_drawCallCount++;
 	}
-
-	glDrawArrays(primitiveMode, 0, m_vertexBuffer.size());
-
-	m_drawCallCount++;
 }
 
 void CGSH_OpenGL::DrawToDepth(unsigned int primitiveType, uint64 primReg)
@@ -1795,7 +2053,7 @@ void CGSH_OpenGL::DrawToDepth(unsigned int primitiveType, uint64 primReg)
 	if(primitiveType != PRIM_SPRITE) return;
 
 	//Invalidate state
-	FlushVertexBuffer();
+	FlushDrawBatches();
 	m_renderState.isValid = false;
 
 	auto prim = make_convertible<PRMODE>(primReg);
@@ -1808,6 +2066,7 @@ void CGSH_OpenGL::DrawToDepth(unsigned int primitiveType, uint64 primReg)
 	auto depthbuffer = FindDepthbuffer(zbufWrite, frame);
 	assert(depthbuffer);
 
+	glBindFramebuffer(GL_FRAMEBUFFER, m_renderState.framebufferHandle);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthbuffer->m_depthBuffer);
 	CHECKGLERROR();
 
@@ -1817,7 +2076,7 @@ void CGSH_OpenGL::DrawToDepth(unsigned int primitiveType, uint64 primReg)
 	glClearDepthf(0);
 	glClear(GL_DEPTH_BUFFER_BIT);
 
-	m_validGlState &= ~GLSTATE_DEPTHMASK;
+	m_validGlState &= ~(GLSTATE_DEPTHMASK | GLSTATE_FRAMEBUFFER);
 }
 
 void CGSH_OpenGL::CopyToFb(
@@ -2055,7 +2314,7 @@ void CGSH_OpenGL::ProcessLocalToHostTransfer()
 	if(framebufferIterator == std::end(m_framebuffers)) return;
 	const auto& framebuffer = (*framebufferIterator);
 
-	FlushVertexBuffer();
+	FlushDrawBatches();
 	m_renderState.isValid = false;
 
 	auto pixels = new uint32[trxReg.nRRW * trxReg.nRRH];
@@ -2099,7 +2358,7 @@ void CGSH_OpenGL::ProcessLocalToLocalTransfer()
 
 	if(foundSrc && foundDest)
 	{
-		FlushVertexBuffer();
+		FlushDrawBatches();
 		m_renderState.isValid = false;
 
 		const auto& srcFramebuffer = (*srcFramebufferIterator);
@@ -2119,7 +2378,7 @@ void CGSH_OpenGL::ProcessLocalToLocalTransfer()
 	}
 	else if(foundSrc && !foundDest)
 	{
-		FlushVertexBuffer();
+		FlushDrawBatches();
 		m_renderState.isValid = false;
 
 		auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
@@ -2205,6 +2464,9 @@ Framework::CBitmap CGSH_OpenGL::GetFramebuffer(uint64 frameReg)
 Framework::CBitmap CGSH_OpenGL::GetFramebufferImpl(uint64 frameReg)
 {
 #ifndef GLES_COMPATIBILITY
+	FlushDrawBatches();
+	m_validGlState &= ~GLSTATE_FRAMEBUFFER;
+
 	auto frame = make_convertible<FRAME>(frameReg);
 	auto framebuffer = FindFramebuffer(frame);
 	if(!framebuffer)
@@ -2245,6 +2507,9 @@ Framework::CBitmap CGSH_OpenGL::GetTextureImpl(uint64 tex0Reg, uint32 maxMip, ui
 		return Framework::CBitmap();
 	}
 
+	FlushDrawBatches();
+	m_validGlState &= ~(GLSTATE_FRAMEBUFFER | GLSTATE_TEXTURE);
+
 	auto tex0 = make_convertible<TEX0>(tex0Reg);
 	auto width = std::max<uint32>(tex0.GetWidth() >> mipLevel, 1);
 	auto height = std::max<uint32>(tex0.GetHeight() >> mipLevel, 1);
@@ -2417,6 +2682,9 @@ CGSH_OpenGL::CFramebuffer::~CFramebuffer()
 
 void CGSH_OpenGL::PopulateFramebuffer(const FramebufferPtr& framebuffer)
 {
+	FlushDrawBatches();
+	m_validGlState &= ~(GLSTATE_FRAMEBUFFER | GLSTATE_TEXTURE);
+
 	auto texFormat = GetTextureFormatInfo(framebuffer->m_psm);
 
 	glActiveTexture(GL_TEXTURE0);
@@ -2427,8 +2695,8 @@ void CGSH_OpenGL::PopulateFramebuffer(const FramebufferPtr& framebuffer)
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	((this)->*(m_textureUpdater[framebuffer->m_psm]))(framebuffer->m_basePtr,
-	                                                  framebuffer->m_width / 64, 0, 0, framebuffer->m_width, framebuffer->m_height);
+	((this)->*(GetFramebufferUpdater(framebuffer->m_psm)))(framebuffer->m_basePtr,
+	                                                       framebuffer->m_width / 64, 0, 0, framebuffer->m_width, framebuffer->m_height);
 	CHECKGLERROR();
 
 	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->m_framebuffer);
@@ -2472,6 +2740,11 @@ void CGSH_OpenGL::CommitFramebufferDirtyPages(const FramebufferPtr& framebuffer,
 	};
 
 	auto& cachedArea = framebuffer->m_cachedArea;
+	if(cachedArea.HasDirtyPages())
+	{
+		//Pending draws must land before we overwrite the framebuffer's contents
+		FlushDrawBatches();
+	}
 
 	auto texturePageSize = CGsPixelFormats::GetPsmPageSize(framebuffer->m_psm);
 
@@ -2509,8 +2782,8 @@ void CGSH_OpenGL::CommitFramebufferDirtyPages(const FramebufferPtr& framebuffer,
 		m_validGlState &= ~(GLSTATE_SCISSOR | GLSTATE_FRAMEBUFFER | GLSTATE_TEXTURE);
 		copyToFbEnabler.EnableCopyToFb(framebuffer, m_copyToFbTexture);
 
-		((this)->*(m_textureUpdater[framebuffer->m_psm]))(framebuffer->m_basePtr, framebuffer->m_width / 64,
-		                                                  texX, texY, texWidth, texHeight);
+		((this)->*(GetFramebufferUpdater(framebuffer->m_psm)))(framebuffer->m_basePtr, framebuffer->m_width / 64,
+		                                                       texX, texY, texWidth, texHeight);
 
 		CopyToFb(
 		    texX, texY, (texX + texWidth), (texY + texHeight),
@@ -2530,6 +2803,7 @@ void CGSH_OpenGL::ResolveFramebufferMultisample(const FramebufferPtr& framebuffe
 {
 	if(!framebuffer->m_resolveNeeded) return;
 
+	FlushDrawBatches();
 	m_validGlState &= ~(GLSTATE_SCISSOR | GLSTATE_FRAMEBUFFER);
 
 	glDisable(GL_SCISSOR_TEST);
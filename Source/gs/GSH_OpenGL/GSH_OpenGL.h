@@ -2,9 +2,11 @@
 
 #include <list>
 #include <unordered_map>
+#include <vector>
 #include "../GSHandler.h"
 #include "../GsDebuggerInterface.h"
 #include "../GsCachedArea.h"
+#include "../GsSpriteRegion.h"
 #include "../GsTextureCache.h"
 #include "opengl/OpenGlDef.h"
 #include "opengl/Program.h"
@@ -13,6 +15,7 @@
 
 #define PREF_CGSH_OPENGL_RESOLUTION_FACTOR "renderer.opengl.resfactor"
 #define PREF_CGSH_OPENGL_FORCEBILINEARTEXTURES "renderer.opengl.forcebilineartextures"
+#define PREF_CGSH_OPENGL_SHADERCACHE "renderer.opengl.shadercache"
 
 #if !defined(GLES_COMPATIBILITY) && !defined(__APPLE__)
 //- Dual source blending is disabled on macOS because it seems to be problematic on
@@ -20,6 +23,12 @@
 #define USE_DUALSOURCE_BLENDING
 #endif
 
+#if !defined(GLES_COMPATIBILITY) && !defined(__APPLE__)
+//- Persistent buffer mapping requires ARB_buffer_storage which isn't available on macOS
+//  and is only an extension on GLES.
+#define USE_PERSISTENT_STREAM_BUFFERS
+#endif
+
 class CGSH_OpenGL : public CGSHandler, public CGsDebuggerInterface
 {
 public:
@@ -128,12 +137,15 @@ private:
 		//OpenGL state
 		GLuint shaderHandle;
 		GLuint framebufferHandle;
+		GLuint framebufferTextureHandle;
+		GLuint depthbufferHandle;
 		GLuint texture0Handle;
 		GLint texture0MinFilter;
 		GLint texture0MagFilter;
 		GLint texture0WrapS;
 		GLint texture0WrapT;
 		bool texture0AlphaAsIndex;
+		bool texture0IsFramebuffer;
 		GLuint texture1Handle;
 		GLsizei viewportWidth;
 		GLsizei viewportHeight;
@@ -142,12 +154,17 @@ private:
 		GLsizei scissorWidth;
 		GLsizei scissorHeight;
 		bool blendEnabled;
+		GLenum blendSrcFactor;
+		GLenum blendDstFactor;
+		GLenum blendEquation;
+		float blendColorAlpha;
 		bool colorMaskR;
 		bool colorMaskG;
 		bool colorMaskB;
 		bool colorMaskA;
 		bool depthMask;
 		bool depthTest;
+		GLenum depthFunc;
 	};
 
 	//These need to match the layout of the shader's uniform block
@@ -270,6 +287,7 @@ private:
 		float scaleRatioX = 1;
 		float scaleRatioY = 1;
 		bool alphaAsIndex = false;
+		bool isFramebuffer = false;
 	};
 
 	struct TEXTUREFORMAT_INFO
@@ -299,15 +317,86 @@ private:
 
 	enum VERTEX_BUFFER_SIZE
 	{
-		VERTEX_BUFFER_SIZE = 0x1000,
+		VERTEX_BUFFER_SIZE = 0x10000,
+	};
+
+	enum
+	{
+		PRIM_STREAM_SEGMENT_SIZE = 0x400000,
+		UNIFORM_STREAM_SEGMENT_SIZE = 0x40000,
+		FRAMEBUFFER_UPLOAD_SEGMENT_SIZE = 0x100000,
 	};
 
+	enum
+	{
+		MAX_DRAW_BATCHES = 256,
+		//How far back we look for a batch to merge with
+		DRAW_BATCH_MERGE_LOOKBACK = 16,
+	};
+
+	//Ring buffer used to stream data to the GPU without orphaning. Buffer is split in
+	//segments that are only reused once the GPU is done with them (tracked with fences).
+	class CStreamBuffer
+	{
+	public:
+		enum
+		{
+			SEGMENT_COUNT = 3,
+		};
+
+		CStreamBuffer(GLenum, uint32, uint32, bool);
+		~CStreamBuffer();
+
+		CStreamBuffer(const CStreamBuffer&) = delete;
+		CStreamBuffer& operator=(const CStreamBuffer&) = delete;
+
+		operator GLuint() const;
+
+		void Reserve(uint32);
+		uint32 Write(const void*, uint32);
+		uint32 GetSegmentSerial() const;
+
+	private:
+		uint32 AlignOffset(uint32) const;
+		void NextSegment();
+
+		GLenum m_target = GL_NONE;
+		GLuint m_buffer = 0;
+		uint32 m_segmentSize = 0;
+		uint32 m_alignment = 1;
+		uint8* m_persistentPtr = nullptr;
+		GLsync m_fences[SEGMENT_COUNT] = {};
+		uint32 m_segmentIndex = 0;
+		uint32 m_segmentSerial = 0;
+		uint32 m_offset = 0;
+	};
+	typedef std::shared_ptr<CStreamBuffer> StreamBufferPtr;
+
 	typedef std::vector<PRIM_VERTEX> VertexBuffer;
 
+	//Vertices recorded with the same GL state, waiting to be drawn
+	struct DRAW_BATCH
+	{
+		RENDERSTATE renderState;
+		VERTEXPARAMS vertexParams;
+		FRAGMENTPARAMS fragmentParams;
+		GLenum primitiveMode = GL_NONE;
+		VertexBuffer vertices;
+		CGsSpriteRegion drawRegion;
+		bool canMerge = true;
+	};
+	typedef std::vector<DRAW_BATCH> DrawBatchList;
+
 	void WriteRegisterImpl(uint8, uint64) override;
 
 	void InitializeRC();
 	void CheckExtensions();
+
+	//Shader Cache
+	std::string GetShaderCacheDriverString() const;
+	void LoadShaderCache();
+	void SaveShaderCache();
+	Framework::OpenGl::ProgramPtr LoadShaderBinary(uint32, const std::vector<uint8>&);
 	void SetupTextureUpdaters();
 	virtual void PresentBackbuffer() = 0;
 	void MakeLinearZOrtho(float*, float, float, float, float);
@@ -319,6 +408,7 @@ private:
 	void VertexKick(uint8, uint64);
 
 	Framework::OpenGl::ProgramPtr GetShaderFromCaps(const SHADERCAPS&);
+	ShaderMap::iterator RegisterShader(const SHADERCAPS&, const Framework::OpenGl::ProgramPtr&);
 	Framework::OpenGl::ProgramPtr GenerateShader(const SHADERCAPS&);
 	Framework::OpenGl::CShader GenerateVertexShader(const SHADERCAPS&);
 	Framework::OpenGl::CShader GenerateFragmentShader(const SHADERCAPS&);
@@ -335,7 +425,7 @@ private:
 	Framework::OpenGl::CVertexArray GenerateCopyToFbVertexArray();
 
 	Framework::OpenGl::CVertexArray GeneratePrimVertexArray();
-	Framework::OpenGl::CBuffer GenerateUniformBlockBuffer(size_t);
+	StreamBufferPtr GenerateUniformStreamBuffer();
 
 	void Prim_Point();
 	void Prim_Line();
@@ -343,7 +433,13 @@ private:
 	void Prim_Sprite();
 
 	void FlushVertexBuffer();
-	void DoRenderPass();
+	void FlushDrawBatches();
+	void SubmitDrawBatches();
+	DRAW_BATCH* FindMergeableDrawBatch(GLenum, const CGsSpriteRect&);
+	bool IsSameDrawState(const DRAW_BATCH&, GLenum) const;
+	static bool IsSameGlState(const RENDERSTATE&, const RENDERSTATE&);
+	CGsSpriteRect GetVertexBufferBounds() const;
+	void DoRenderPass(const DRAW_BATCH&);
 
 	void CopyToFb(int32, int32, int32, int32, int32, int32, int32, int32, int32, int32);
 	void DrawToDepth(unsigned int, uint64);
@@ -387,6 +483,10 @@ private:
 	template <uint32, uint32>
 	void TexUpdater_Psm48H(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
 
+	//Framebuffer updaters
+	TEXTUREUPDATER GetFramebufferUpdater(uint32) const;
+	void FramebufferUpdater_Psm32(uint32, uint32, unsigned int, unsigned int, unsigned int, unsigned int);
+
 	//Context variables (put this in a struct or something?)
 	float m_nPrimOfsX;
 	float m_nPrimOfsY;
@@ -429,9 +529,12 @@ private:
 	FramebufferList m_framebuffers;
 	DepthbufferList m_depthbuffers;
 
-	Framework::OpenGl::CBuffer m_primBuffer;
+	StreamBufferPtr m_primStreamBuffer;
 	Framework::OpenGl::CVertexArray m_primVertexArray;
 
+	//Pixel unpack buffer used to upload framebuffer pages written by the CPU
+	StreamBufferPtr m_framebufferUploadBuffer;
+
 	VERTEX m_VtxBuffer[3];
 	int m_nVtxCount;
 
@@ -467,11 +570,28 @@ private:
 	uint32 m_validGlState = 0;
 	VERTEXPARAMS m_vertexParams;
 	FRAGMENTPARAMS m_fragmentParams;
-	Framework::OpenGl::CBuffer m_vertexParamsBuffer;
-	Framework::OpenGl::CBuffer m_fragmentParamsBuffer;
+	StreamBufferPtr m_uniformStreamBuffer;
+	uint32 m_uniformStreamSegmentSerial = 0;
+	uint32 m_vertexParamsOffset = 0;
+	uint32 m_fragmentParamsOffset = 0;
 	VertexBuffer m_vertexBuffer;
 
+	//Draws are queued and only submitted when something needs the result (texture sampling,
+	//transfers, flip). This allows non overlapping draws that share the same state to be merged
+	//even if some other state was used in between (ie.: HUD elements alternating between 2 textures).
+	DrawBatchList m_drawBatches;
+	uint32 m_drawBatchCount = 0;
+	RENDERSTATE m_appliedRenderState;
+	VERTEXPARAMS m_appliedVertexParams;
+	FRAGMENTPARAMS m_appliedFragmentParams;
+
 	//If GPU has framebuffer fetch extension, some things will be done
 	//within the shader, such alpha blending
 	bool m_hasFramebufferFetchExtension = false;
+
+	bool m_hasBufferStorageExtension = false;
+
+	//Program binaries can be retrieved and reloaded to avoid compiling shaders on every boot
+	bool m_hasProgramBinarySupport = false;
+	bool m_shaderCacheEnabled = false;
 };
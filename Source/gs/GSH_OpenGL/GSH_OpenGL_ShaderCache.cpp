@@ -0,0 +1,192 @@
+#include "GSH_OpenGL.h"
+#include <assert.h>
+#include <algorithm>
+#include "StdStreamUtils.h"
+#include "../../Log.h"
+#include "../../AppConfig.h"
+
+#define LOG_NAME ("gsh_opengl")
+
+#define SHADER_CACHE_FILENAME ("opengl_shadercache.bin")
+#define SHADER_CACHE_MAGIC 0x43534C47 //'GLSC'
+//Increment this when shader generation changes to make sure stale binaries are not used
+#define SHADER_CACHE_VERSION 1
+//Limits used to reject corrupted files before allocating or looping on garbage
+#define SHADER_CACHE_MAX_DRIVER_STRING_LENGTH 0x400
+#define SHADER_CACHE_MAX_ENTRY_COUNT 0x1000
+#define SHADER_CACHE_MAX_BINARY_SIZE 0x1000000
+
+//File layout:
+//- uint32 magic
+//- uint32 version
+//- uint32 driverStringLength, char driverString[driverStringLength]
+//- uint32 entryCount
+//- Entries:
+//  - uint64 shaderCaps
+//  - uint32 binaryFormat
+//  - uint32 binarySize, uint8 binary[binarySize]
+//Entries with no binary (or with binaries from another driver) are still useful, their
+//programs are compiled from source during initialization instead of at first use.
+//Loading stops at the first entry that can't be read completely.
+
+std::string CGSH_OpenGL::GetShaderCacheDriverString() const
+{
+	auto getString = [](GLenum name) {
+		auto value = reinterpret_cast<const char*>(glGetString(name));
+		return std::string(value ? value : "");
+	};
+	return getString(GL_VENDOR) + "/" + getString(GL_RENDERER) + "/" + getString(GL_VERSION);
+}
+
+void CGSH_OpenGL::LoadShaderCache()
+{
+	if(!m_shaderCacheEnabled) return;
+
+	auto cachePath = CAppConfig::GetInstance().GetBasePath() / SHADER_CACHE_FILENAME;
+	uint32 binaryCount = 0;
+	uint32 compiledCount = 0;
+	try
+	{
+		auto stream = Framework::CreateInputStdStream(cachePath.native());
+		uint32 magic = 0, version = 0;
+		if(stream.Read(&magic, sizeof(uint32)) != sizeof(uint32)) return;
+		if(stream.Read(&version, sizeof(uint32)) != sizeof(uint32)) return;
+		if((magic != SHADER_CACHE_MAGIC) || (version != SHADER_CACHE_VERSION))
+		{
+			return;
+		}
+
+		uint32 driverStringLength = 0;
+		if(stream.Read(&driverStringLength, sizeof(uint32)) != sizeof(uint32)) return;
+		if(driverStringLength > SHADER_CACHE_MAX_DRIVER_STRING_LENGTH)
+		{
+			CLog::GetInstance().Warn(LOG_NAME, "Discarding shader cache with invalid driver string.\r\n");
+			return;
+		}
+		std::string driverString(driverStringLength, 0);
+		if(stream.Read(driverString.data(), driverString.size()) != driverString.size()) return;
+		bool useBinaries = m_hasProgramBinarySupport && (driverString == GetShaderCacheDriverString());
+
+		uint32 entryCount = 0;
+		if(stream.Read(&entryCount, sizeof(uint32)) != sizeof(uint32)) return;
+		if(entryCount > SHADER_CACHE_MAX_ENTRY_COUNT)
+		{
+			CLog::GetInstance().Warn(LOG_NAME, "Discarding shader cache with too many entries (%d).\r\n", entryCount);
+			return;
+		}
+		std::vector<uint8> binary;
+		for(uint32 i = 0; i < entryCount; i++)
+		{
+			ShaderCapsInt shaderCapsInt = 0;
+			if(stream.Read(&shaderCapsInt, sizeof(ShaderCapsInt)) != sizeof(ShaderCapsInt)) break;
+			uint32 binaryFormat = 0;
+			if(stream.Read(&binaryFormat, sizeof(uint32)) != sizeof(uint32)) break;
+			uint32 binarySize = 0;
+			if(stream.Read(&binarySize, sizeof(uint32)) != sizeof(uint32)) break;
+			if(binarySize > SHADER_CACHE_MAX_BINARY_SIZE) break;
+			binary.resize(binarySize);
+			if(stream.Read(binary.data(), binary.size()) != binary.size()) break;
+
+			auto shaderCaps = make_convertible<SHADERCAPS>(shaderCapsInt);
+			if(m_shaders.find(shaderCaps) != m_shaders.end()) continue;
+
+			Framework::OpenGl::ProgramPtr shader;
+			if(useBinaries && !binary.empty())
+			{
+				shader = LoadShaderBinary(binaryFormat, binary);
+			}
+			if(shader)
+			{
+				binaryCount++;
+			}
+			else
+			{
+				shader = GenerateShader(shaderCaps);
+				compiledCount++;
+			}
+			RegisterShader(shaderCaps, shader);
+		}
+	}
+	catch(...)
+	{
+		//Cache doesn't exist yet or can't be read, keep whatever we managed to load
+	}
+
+	CLog::GetInstance().Print(LOG_NAME, "Shader cache: loaded %d program binaries, compiled %d programs.\r\n",
+	                          binaryCount, compiledCount);
+}
+
+void CGSH_OpenGL::SaveShaderCache()
+{
+	if(!m_shaderCacheEnabled) return;
+	if(m_shaders.empty()) return;
+
+	auto cachePath = CAppConfig::GetInstance().GetBasePath() / SHADER_CACHE_FILENAME;
+	try
+	{
+		auto stream = Framework::CreateOutputStdStream(cachePath.native());
+		stream.Write32(SHADER_CACHE_MAGIC);
+		stream.Write32(SHADER_CACHE_VERSION);
+
+		//Keep what we write within the limits enforced by LoadShaderCache
+		auto driverString = GetShaderCacheDriverString().substr(0, SHADER_CACHE_MAX_DRIVER_STRING_LENGTH);
+		stream.Write32(static_cast<uint32>(driverString.size()));
+		stream.Write(driverString.data(), driverString.size());
+
+		uint32 entryCount = std::min<uint32>(static_cast<uint32>(m_shaders.size()), SHADER_CACHE_MAX_ENTRY_COUNT);
+		stream.Write32(entryCount);
+		std::vector<uint8> binary;
+		for(const auto& shaderPair : m_shaders)
+		{
+			if(entryCount-- == 0) break;
+			GLenum binaryFormat = 0;
+			binary.clear();
+			if(m_hasProgramBinarySupport)
+			{
+				GLint binaryLength = 0;
+				glGetProgramiv(*shaderPair.second, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+				if(binaryLength > SHADER_CACHE_MAX_BINARY_SIZE) binaryLength = 0;
+				binary.resize(binaryLength);
+				if(binaryLength != 0)
+				{
+					GLsizei writtenLength = 0;
+					glGetProgramBinary(*shaderPair.second, binaryLength, &writtenLength, &binaryFormat, binary.data());
+					binary.resize(writtenLength);
+				}
+			}
+
+			ShaderCapsInt shaderCapsInt = shaderPair.first;
+			stream.Write(&shaderCapsInt, sizeof(ShaderCapsInt));
+			stream.Write32(binaryFormat);
+			stream.Write32(static_cast<uint32>(binary.size()));
+			stream.Write(binary.data(), binary.size());
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to save shader cache: %s\r\n", exception.what());
+	}
+
+	CHECKGLERROR();
+}
+
+Framework::OpenGl::ProgramPtr CGSH_OpenGL::LoadShaderBinary(uint32 binaryFormat, const std::vector<uint8>& binary)
+{
+	assert(m_hasProgramBinarySupport);
+
+	auto result = std::make_shared<Framework::OpenGl::CProgram>();
+	glProgramBinary(*result, binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+	//Driver is allowed to reject binaries at any time (ie.: after an update)
+	GLint linkStatus = GL_FALSE;
+	glGetProgramiv(*result, GL_LINK_STATUS, &linkStatus);
+	if(linkStatus == GL_FALSE)
+	{
+		while(glGetError() != GL_NO_ERROR)
+		{
+		}
+		return Framework::OpenGl::ProgramPtr();
+	}
+
+	return result;
+}
@@ -0,0 +1,127 @@
+#include "GSH_OpenGL.h"
+#include <assert.h>
+#include <cstring>
+
+/////////////////////////////////////////////////////////////
+// Stream Buffer
+/////////////////////////////////////////////////////////////
+
+CGSH_OpenGL::CStreamBuffer::CStreamBuffer(GLenum target, uint32 segmentSize, uint32 alignment, bool usePersistentMapping)
+    : m_target(target)
+    , m_segmentSize(segmentSize)
+    , m_alignment(alignment)
+{
+	assert((m_segmentSize % m_alignment) == 0);
+
+	uint32 bufferSize = m_segmentSize * SEGMENT_COUNT;
+
+	glGenBuffers(1, &m_buffer);
+	glBindBuffer(m_target, m_buffer);
+
+#ifdef USE_PERSISTENT_STREAM_BUFFERS
+	if(usePersistentMapping)
+	{
+		static const GLbitfield mapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		glBufferStorage(m_target, bufferSize, nullptr, mapFlags);
+		m_persistentPtr = reinterpret_cast<uint8*>(glMapBufferRange(m_target, 0, bufferSize, mapFlags));
+		assert(m_persistentPtr);
+	}
+	else
+#endif
+	{
+		glBufferData(m_target, bufferSize, nullptr, GL_STREAM_DRAW);
+	}
+
+	CHECKGLERROR();
+}
+
+CGSH_OpenGL::CStreamBuffer::~CStreamBuffer()
+{
+	for(auto& fence : m_fences)
+	{
+		if(fence)
+		{
+			glDeleteSync(fence);
+		}
+	}
+	if(m_persistentPtr)
+	{
+		glBindBuffer(m_target, m_buffer);
+		glUnmapBuffer(m_target);
+	}
+	glDeleteBuffers(1, &m_buffer);
+}
+
+CGSH_OpenGL::CStreamBuffer::operator GLuint() const
+{
+	return m_buffer;
+}
+
+void CGSH_OpenGL::CStreamBuffer::Reserve(uint32 size)
+{
+	//Worst case, every write needs padding to satisfy alignment
+	assert(size <= (m_segmentSize - m_alignment));
+	uint32 segmentEnd = (m_segmentIndex + 1) * m_segmentSize;
+	if((AlignOffset(m_offset) + size + m_alignment) > segmentEnd)
+	{
+		NextSegment();
+	}
+}
+
+uint32 CGSH_OpenGL::CStreamBuffer::Write(const void* data, uint32 size)
+{
+	assert(size <= m_segmentSize);
+	uint32 segmentEnd = (m_segmentIndex + 1) * m_segmentSize;
+	if((AlignOffset(m_offset) + size) > segmentEnd)
+	{
+		NextSegment();
+	}
+
+	uint32 offset = AlignOffset(m_offset);
+	if(m_persistentPtr)
+	{
+		memcpy(m_persistentPtr + offset, data, size);
+	}
+	else
+	{
+		//Segment isn't used by the GPU anymore, no need to synchronize
+		glBindBuffer(m_target, m_buffer);
+		auto bufferPtr = glMapBufferRange(m_target, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		assert(bufferPtr);
+		memcpy(bufferPtr, data, size);
+		glUnmapBuffer(m_target);
+	}
+	m_offset = offset + size;
+	return offset;
+}
+
+uint32 CGSH_OpenGL::CStreamBuffer::GetSegmentSerial() const
+{
+	return m_segmentSerial;
+}
+
+uint32 CGSH_OpenGL::CStreamBuffer::AlignOffset(uint32 offset) const
+{
+	return ((offset + m_alignment - 1) / m_alignment) * m_alignment;
+}
+
+void CGSH_OpenGL::CStreamBuffer::NextSegment()
+{
+	assert(!m_fences[m_segmentIndex]);
+	m_fences[m_segmentIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	m_segmentIndex = (m_segmentIndex + 1) % SEGMENT_COUNT;
+	m_offset = m_segmentIndex * m_segmentSize;
+	m_segmentSerial++;
+
+	//Wait until the GPU is done reading from the segment we're about to overwrite
+	auto& fence = m_fences[m_segmentIndex];
+	if(fence)
+	{
+		while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, ~0ULL) == GL_TIMEOUT_EXPIRED)
+		{
+		}
+		glDeleteSync(fence);
+		fence = nullptr;
+	}
+}
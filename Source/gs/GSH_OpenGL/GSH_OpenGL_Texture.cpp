@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <cstdint>
 #include <cstring>
 #include <sys/stat.h>
 #include <limits.h>
@@ -163,6 +164,9 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::SearchTextureFramebuffer(const TEX0& tex0
 
 	if(framebuffer)
 	{
+		//Pending draws might be rendering to this framebuffer
+		FlushDrawBatches();
+
 		CommitFramebufferDirtyPages(framebuffer, 0, tex0.GetHeight());
 		if(m_multisampleEnabled)
 		{
@@ -175,6 +179,7 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::SearchTextureFramebuffer(const TEX0& tex0
 		texInfo.textureHandle = framebuffer->m_texture;
 		texInfo.scaleRatioX = scaleRatioX;
 		texInfo.scaleRatioY = scaleRatioY;
+		texInfo.isFramebuffer = true;
 		return texInfo;
 	}
 	else
@@ -194,6 +199,9 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::PrepareTexture(const TEX0& tex0)
 	auto texture = m_textureCache.Search(tex0);
 	if(!texture)
 	{
+		//Inserting in the cache might evict a texture used by pending draws
+		FlushDrawBatches();
+
 		//Validate texture dimensions to prevent problems
 		auto texWidth = tex0.GetWidth();
 		auto texHeight = tex0.GetHeight();
@@ -217,8 +225,15 @@ CGSH_OpenGL::TEXTURE_INFO CGSH_OpenGL::PrepareTexture(const TEX0& tex0)
 
 	texInfo.textureHandle = texture->m_textureHandle;
 
-	glBindTexture(GL_TEXTURE_2D, texture->m_textureHandle);
 	auto& cachedArea = texture->m_cachedArea;
+	if(cachedArea.HasDirtyPages())
+	{
+		//Pending draws need to sample the texture's previous contents
+		FlushDrawBatches();
+		glBindTexture(GL_TEXTURE_2D, texture->m_textureHandle);
+		m_validGlState &= ~GLSTATE_TEXTURE;
+	}
+
 	auto texturePageSize = CGsPixelFormats::GetPsmPageSize(tex0.nPsm);
 	auto areaRect = cachedArea.GetAreaPageRect();
 
@@ -270,8 +285,12 @@ GLuint CGSH_OpenGL::PreparePalette(const TEX0& tex0)
 		return textureHandle;
 	}
 
+	//Inserting in the cache might evict a palette used by pending draws
+	FlushDrawBatches();
+
 	glGenTextures(1, &textureHandle);
 	glBindTexture(GL_TEXTURE_2D, textureHandle);
+	m_validGlState &= ~GLSTATE_TEXTURE;
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, entryCount, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, convertedClut.data());
 
 	PalCache_Insert(tex0, convertedClut.data(), textureHandle);
@@ -678,6 +697,144 @@ void CGSH_OpenGL::TexUpdater_Psm48H(uint32 bufPtr, uint32 bufWidth, unsigned int
 	CHECKGLERROR();
 }
 
+/////////////////////////////////////////////////////////////
+// Framebuffer Loading
+/////////////////////////////////////////////////////////////
+
+#if defined(FRAMEWORK_SIMD_USE_SSE)
+
+//A PSMCT32 column is 8x2 pixels stored as 2x2 squares, each 16 bytes chunk
+//holds 2 pixels of the first row followed by 2 pixels of the second row
+inline void convertColumn32(uint32* dest, const int destStride, const uint32* src)
+{
+	auto mSrc = reinterpret_cast<const __m128i*>(src);
+	auto mDest0 = reinterpret_cast<__m128i*>(dest);
+	auto mDest1 = reinterpret_cast<__m128i*>(dest + destStride);
+
+	__m128i a = _mm_loadu_si128(mSrc + 0);
+	__m128i b = _mm_loadu_si128(mSrc + 1);
+	__m128i c = _mm_loadu_si128(mSrc + 2);
+	__m128i d = _mm_loadu_si128(mSrc + 3);
+
+	_mm_storeu_si128(mDest0 + 0, _mm_unpacklo_epi64(a, b));
+	_mm_storeu_si128(mDest0 + 1, _mm_unpacklo_epi64(c, d));
+	_mm_storeu_si128(mDest1 + 0, _mm_unpackhi_epi64(a, b));
+	_mm_storeu_si128(mDest1 + 1, _mm_unpackhi_epi64(c, d));
+}
+
+#elif defined(FRAMEWORK_SIMD_USE_NEON)
+
+inline void convertColumn32(uint32* dest, const int destStride, const uint32* src)
+{
+	uint32x4_t a = vld1q_u32(src + 0);
+	uint32x4_t b = vld1q_u32(src + 4);
+	uint32x4_t c = vld1q_u32(src + 8);
+	uint32x4_t d = vld1q_u32(src + 12);
+
+	vst1q_u32(dest + 0, vcombine_u32(vget_low_u32(a), vget_low_u32(b)));
+	vst1q_u32(dest + 4, vcombine_u32(vget_low_u32(c), vget_low_u32(d)));
+	vst1q_u32(dest + destStride + 0, vcombine_u32(vget_high_u32(a), vget_high_u32(b)));
+	vst1q_u32(dest + destStride + 4, vcombine_u32(vget_high_u32(c), vget_high_u32(d)));
+}
+
+#else
+
+inline void convertColumn32(uint32* dest, const int destStride, const uint32* src)
+{
+	for(unsigned int i = 0; i < 4; i++)
+	{
+		dest[(i * 2) + 0] = src[(i * 4) + 0];
+		dest[(i * 2) + 1] = src[(i * 4) + 1];
+		dest[destStride + (i * 2) + 0] = src[(i * 4) + 2];
+		dest[destStride + (i * 2) + 1] = src[(i * 4) + 3];
+	}
+}
+
+#endif
+
+//Unswizzles the first 'height' rows of a PSMCT32 page
+static void convertPage32(uint32* dest, const int destStride, const uint32* src, unsigned int height)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 Storage;
+
+	for(unsigned int y = 0; y < height; y += Storage::COLUMNHEIGHT)
+	{
+		unsigned int blockY = y / Storage::BLOCKHEIGHT;
+		unsigned int colNum = (y % Storage::BLOCKHEIGHT) / Storage::COLUMNHEIGHT;
+		bool isFullColumn = (y + Storage::COLUMNHEIGHT) <= height;
+		uint32* rowDest = dest + (y * destStride);
+
+		for(unsigned int blockX = 0; blockX < (Storage::PAGEWIDTH / Storage::BLOCKWIDTH); blockX++)
+		{
+			uint32 blockNum = Storage::m_nBlockSwizzleTable[blockY][blockX];
+			const uint32* colSrc = src + ((blockNum * CGsPixelFormats::BLOCKSIZE) + (colNum * CGsPixelFormats::COLUMNSIZE)) / sizeof(uint32);
+			uint32* colDest = rowDest + (blockX * Storage::BLOCKWIDTH);
+			if(isFullColumn)
+			{
+				convertColumn32(colDest, destStride, colSrc);
+			}
+			else
+			{
+				//Odd height, only keep the column's first row
+				uint32 column[Storage::COLUMNWIDTH * Storage::COLUMNHEIGHT];
+				convertColumn32(column, Storage::COLUMNWIDTH, colSrc);
+				memcpy(colDest, column, Storage::COLUMNWIDTH * sizeof(uint32));
+			}
+		}
+	}
+}
+
+CGSH_OpenGL::TEXTUREUPDATER CGSH_OpenGL::GetFramebufferUpdater(uint32 psm) const
+{
+	switch(psm)
+	{
+	case PSMCT32:
+	case PSMCT24:
+		return &CGSH_OpenGL::FramebufferUpdater_Psm32;
+	default:
+		return m_textureUpdater[psm];
+	}
+}
+
+void CGSH_OpenGL::FramebufferUpdater_Psm32(uint32 bufPtr, uint32 bufWidth, unsigned int texX, unsigned int texY, unsigned int texWidth, unsigned int texHeight)
+{
+	typedef CGsPixelFormats::STORAGEPSMCT32 Storage;
+
+	//Framebuffer dirty areas are made of whole pages, except for the height that gets clamped
+	if(((texX % Storage::PAGEWIDTH) != 0) || ((texY % Storage::PAGEHEIGHT) != 0) || ((texWidth % Storage::PAGEWIDTH) != 0))
+	{
+		return TexUpdater_Psm32(bufPtr, bufWidth, texX, texY, texWidth, texHeight);
+	}
+
+	uint32 bufPageCountX = (bufWidth * 64) / Storage::PAGEWIDTH;
+	uint32 rowSize = texWidth * sizeof(uint32);
+	assert((rowSize * Storage::PAGEHEIGHT) <= FRAMEBUFFER_UPLOAD_SEGMENT_SIZE);
+
+	//Convert and upload one row of pages at a time. Data goes through a pixel unpack buffer
+	//to let the driver copy it to the texture asynchronously.
+	for(unsigned int y = 0; y < texHeight; y += Storage::PAGEHEIGHT)
+	{
+		unsigned int rowHeight = std::min<unsigned int>(texHeight - y, Storage::PAGEHEIGHT);
+		uint32 pageY = (texY + y) / Storage::PAGEHEIGHT;
+
+		auto dst = reinterpret_cast<uint32*>(m_pCvtBuffer);
+		for(unsigned int x = 0; x < texWidth; x += Storage::PAGEWIDTH)
+		{
+			uint32 pageX = (texX + x) / Storage::PAGEWIDTH;
+			uint32 pageAddress = (bufPtr + ((pageX + (pageY * bufPageCountX)) * CGsPixelFormats::PAGESIZE)) & (RAMSIZE - 1);
+			convertPage32(dst + x, texWidth, reinterpret_cast<const uint32*>(m_pRAM + pageAddress), rowHeight);
+		}
+
+		uint32 uploadOffset = m_framebufferUploadBuffer->Write(m_pCvtBuffer, rowSize * rowHeight);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, *m_framebufferUploadBuffer);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, texX, texY + y, texWidth, rowHeight, GL_RGBA, GL_UNSIGNED_BYTE,
+		                reinterpret_cast<const void*>(static_cast<uintptr_t>(uploadOffset)));
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	}
+
+	CHECKGLERROR();
+}
+
 /////////////////////////////////////////////////////////////
 // Palette
 /////////////////////////////////////////////////////////////
@@ -1,6 +1,9 @@
 #include "GSH_Vulkan.h"
 #include <cstring>
 #include "std_experimental_map.h"
+#include "string_format.h"
+#include "StdStreamUtils.h"
+#include "PathUtils.h"
 #include "../GsPixelFormats.h"
 #include "../GsTransferRange.h"
 #include "../../Log.h"
@@ -16,6 +19,26 @@
 
 #define LOG_NAME ("gsh_vulkan")
 
+#define CACHE_PATH ("vulkan")
+
+#if GSH_VULKAN_IS_DESKTOP
+#define DRAW_PIPELINE_CAPS_FILENAME ("drawcaps_desktop.bin")
+#else
+#define DRAW_PIPELINE_CAPS_FILENAME ("drawcaps_mobile.bin")
+#endif
+#define DRAW_PIPELINE_CAPS_MAGIC 0x50444B56 //'VKDP'
+//Increment this when the layout of CDraw::PIPELINE_CAPS changes to make sure stale lists are not used
+#define DRAW_PIPELINE_CAPS_VERSION 1
+//Limits the amount of pipelines compiled at startup, also protects against garbage files
+#define DRAW_PIPELINE_CAPS_MAX_COUNT 0x1000
+
+//Draw pipeline caps file layout:
+//- uint32 magic
+//- uint32 version
+//- uint32 driverStringLength, char driverString[driverStringLength]
+//- uint32 entryCount
+//- uint64 pipelineCaps[entryCount]
+
 using namespace GSH_Vulkan;
 
 static uint32 MakeColor(uint8 r, uint8 g, uint8 b, uint8 a)
@@ -150,6 +173,7 @@ void CGSH_Vulkan::InitializeImpl()
 	CreateDescriptorPool();
 	CreateMemoryBuffer();
 	CreateClutBuffer();
+	CreatePipelineCache();
 
 	m_swizzleTablePSMCT32 = CreateSwizzleTable<CGsPixelFormats::STORAGEPSMCT32>(m_context->device, m_context->physicalDeviceMemoryProperties, m_context->queue, m_context->commandBufferPool);
 	m_swizzleTablePSMCT16 = CreateSwizzleTable<CGsPixelFormats::STORAGEPSMCT16>(m_context->device, m_context->physicalDeviceMemoryProperties, m_context->queue, m_context->commandBufferPool);
@@ -196,6 +220,7 @@ void CGSH_Vulkan::InitializeImpl()
 #else
 #error Unsupported Vulkan flavor
 #endif
+	PrewarmDrawPipelines();
 	if(m_context->surface)
 	{
 		m_present = std::make_shared<CPresent>(m_context);
@@ -215,6 +240,8 @@ void CGSH_Vulkan::ReleaseImpl()
 	//Flush any pending rendering commands
 	m_context->device.vkQueueWaitIdle(m_context->queue);
 
+	SaveDrawPipelineCapsList();
+
 	m_clutLoad.reset();
 	m_draw.reset();
 	m_present.reset();
@@ -246,6 +273,7 @@ void CGSH_Vulkan::ReleaseImpl()
 	m_context->memoryBufferCopy.Reset();
 	m_context->memoryBufferTransfer.Reset();
 	m_context->commandBufferPool.Reset();
+	SavePipelineCache();
 	m_context->device.Reset();
 
 	delete[] m_memoryCache;
@@ -262,6 +290,10 @@ void CGSH_Vulkan::ResetImpl()
 	memset(&m_clutStates, 0, sizeof(m_clutStates));
 	memset(m_memoryCache, 0, RAMSIZE);
 	WriteBackMemoryCache();
+	for(auto& xferHistoryPair : m_xferHistory)
+	{
+		xferHistoryPair.second.predictedCopySerial = 0;
+	}
 }
 
 void CGSH_Vulkan::SetPresentationParams(const CGSHandler::PRESENTATION_PARAMS& presentationParams)
@@ -272,6 +304,7 @@ void CGSH_Vulkan::SetPresentationParams(const CGSHandler::PRESENTATION_PARAMS& p
 
 void CGSH_Vulkan::MarkNewFrame()
 {
+	IssuePredictedReadbacks();
 	m_drawCallCount = m_frameCommandBuffer->GetFlushCount();
 	m_frameCommandBuffer->ResetFlushCount();
 	m_frameCommandBuffer->EndFrame();
@@ -591,6 +624,168 @@ void CGSH_Vulkan::CreateClutBuffer()
 	m_context->annotations.SetBufferName(m_context->clutBuffer, "CLUT Buffer");
 }
 
+void CGSH_Vulkan::CreatePipelineCache()
+{
+	assert(m_context->pipelineCache == VK_NULL_HANDLE);
+
+	//Driver will ignore data that doesn't match its header, but keep one file per
+	//device/driver anyway to avoid switching GPUs throwing away the other one's cache
+	VkPhysicalDeviceProperties deviceProperties = {};
+	m_instance.vkGetPhysicalDeviceProperties(m_context->physicalDevice, &deviceProperties);
+
+	std::string cacheUuid;
+	for(auto uuidByte : deviceProperties.pipelineCacheUUID)
+	{
+		cacheUuid += string_format("%02x", uuidByte);
+	}
+
+	auto cachePath = CAppConfig::GetInstance().GetBasePath() / CACHE_PATH;
+	auto cacheFileName = string_format("pipelines_%04x_%04x_%08x_%s.bin",
+	                                   deviceProperties.vendorID, deviceProperties.deviceID,
+	                                   deviceProperties.driverVersion, cacheUuid.c_str());
+	m_pipelineCachePath = cachePath / cacheFileName;
+	m_drawPipelineCapsPath = cachePath / DRAW_PIPELINE_CAPS_FILENAME;
+
+	std::vector<uint8> cacheData;
+	try
+	{
+		auto stream = Framework::CreateInputStdStream(m_pipelineCachePath.native());
+		cacheData.resize(stream.GetLength());
+		stream.Read(cacheData.data(), cacheData.size());
+	}
+	catch(...)
+	{
+		cacheData.clear();
+	}
+
+	auto pipelineCacheCreateInfo = Framework::Vulkan::PipelineCacheCreateInfo();
+	pipelineCacheCreateInfo.initialDataSize = cacheData.size();
+	pipelineCacheCreateInfo.pInitialData = cacheData.data();
+
+	auto result = m_context->device.vkCreatePipelineCache(m_context->device, &pipelineCacheCreateInfo, nullptr, &m_context->pipelineCache);
+	if(result != VK_SUCCESS)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to create pipeline cache from '%s', starting from scratch.\n",
+		                         m_pipelineCachePath.string().c_str());
+		pipelineCacheCreateInfo.initialDataSize = 0;
+		pipelineCacheCreateInfo.pInitialData = nullptr;
+		result = m_context->device.vkCreatePipelineCache(m_context->device, &pipelineCacheCreateInfo, nullptr, &m_context->pipelineCache);
+		CHECKVULKANERROR(result);
+	}
+}
+
+void CGSH_Vulkan::SavePipelineCache()
+{
+	if(m_context->pipelineCache == VK_NULL_HANDLE) return;
+
+	size_t cacheDataSize = 0;
+	auto result = m_context->device.vkGetPipelineCacheData(m_context->device, m_context->pipelineCache, &cacheDataSize, nullptr);
+	if((result == VK_SUCCESS) && (cacheDataSize != 0))
+	{
+		std::vector<uint8> cacheData(cacheDataSize);
+		result = m_context->device.vkGetPipelineCacheData(m_context->device, m_context->pipelineCache, &cacheDataSize, cacheData.data());
+		if(result == VK_SUCCESS)
+		{
+			try
+			{
+				Framework::PathUtils::EnsurePathExists(m_pipelineCachePath.parent_path());
+				auto stream = Framework::CreateOutputStdStream(m_pipelineCachePath.native());
+				stream.Write(cacheData.data(), cacheDataSize);
+			}
+			catch(const std::exception& exception)
+			{
+				CLog::GetInstance().Warn(LOG_NAME, "Failed to save pipeline cache: %s\n", exception.what());
+			}
+		}
+	}
+
+	m_context->device.vkDestroyPipelineCache(m_context->device, m_context->pipelineCache, nullptr);
+	m_context->pipelineCache = VK_NULL_HANDLE;
+}
+
+std::string CGSH_Vulkan::GetDrawPipelineCapsDriverString()
+{
+	VkPhysicalDeviceProperties deviceProperties = {};
+	m_instance.vkGetPhysicalDeviceProperties(m_context->physicalDevice, &deviceProperties);
+	return string_format("%04x/%04x/%08x", deviceProperties.vendorID, deviceProperties.deviceID, deviceProperties.driverVersion);
+}
+
+void CGSH_Vulkan::PrewarmDrawPipelines()
+{
+	//Compile draw pipelines used during previous sessions in the background.
+	//Combined with the pipeline cache, this should get rid of most first draw stutters.
+	CDraw::PipelineCapsList capsList;
+	try
+	{
+		auto stream = Framework::CreateInputStdStream(m_drawPipelineCapsPath.native());
+		uint32 magic = stream.Read32();
+		uint32 version = stream.Read32();
+		if((magic != DRAW_PIPELINE_CAPS_MAGIC) || (version != DRAW_PIPELINE_CAPS_VERSION))
+		{
+			CLog::GetInstance().Print(LOG_NAME, "Discarding draw pipeline list with unknown format.\n");
+			return;
+		}
+
+		//Pipelines that worked on a different device or driver might not be relevant anymore
+		std::string driverString(stream.Read32(), 0);
+		stream.Read(driverString.data(), driverString.size());
+		if(driverString != GetDrawPipelineCapsDriverString())
+		{
+			CLog::GetInstance().Print(LOG_NAME, "Discarding draw pipeline list from another device or driver.\n");
+			return;
+		}
+
+		uint32 entryCount = stream.Read32();
+		if(entryCount > DRAW_PIPELINE_CAPS_MAX_COUNT)
+		{
+			CLog::GetInstance().Warn(LOG_NAME, "Discarding draw pipeline list with too many entries (%d).\n", entryCount);
+			return;
+		}
+
+		capsList.resize(entryCount);
+		uint64 capsListSize = capsList.size() * sizeof(CDraw::PipelineCapsInt);
+		if(stream.Read(capsList.data(), capsListSize) != capsListSize)
+		{
+			CLog::GetInstance().Warn(LOG_NAME, "Discarding truncated draw pipeline list.\n");
+			return;
+		}
+	}
+	catch(...)
+	{
+		return;
+	}
+	m_draw->PrewarmPipelines(std::move(capsList));
+}
+
+void CGSH_Vulkan::SaveDrawPipelineCapsList()
+{
+	m_draw->StopPrewarmingPipelines();
+	auto capsList = m_draw->GetPipelineCapsList();
+	if(capsList.empty()) return;
+	if(capsList.size() > DRAW_PIPELINE_CAPS_MAX_COUNT)
+	{
+		capsList.resize(DRAW_PIPELINE_CAPS_MAX_COUNT);
+	}
+	try
+	{
+		Framework::PathUtils::EnsurePathExists(m_drawPipelineCapsPath.parent_path());
+		auto stream = Framework::CreateOutputStdStream(m_drawPipelineCapsPath.native());
+		stream.Write32(DRAW_PIPELINE_CAPS_MAGIC);
+		stream.Write32(DRAW_PIPELINE_CAPS_VERSION);
+
+		auto driverString = GetDrawPipelineCapsDriverString();
+		stream.Write32(static_cast<uint32>(driverString.size()));
+		stream.Write(driverString.data(), driverString.size());
+
+		stream.Write32(static_cast<uint32>(capsList.size()));
+		stream.Write(capsList.data(), capsList.size() * sizeof(CDraw::PipelineCapsInt));
+	}
+	catch(const std::exception& exception)
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Failed to save draw pipeline list: %s\n", exception.what());
+	}
+}
+
 void CGSH_Vulkan::ProcessPrim(uint64 data)
 {
 	unsigned int newPrimitiveType = static_cast<unsigned int>(data & 0x07);
@@ -1426,6 +1621,9 @@ void CGSH_Vulkan::ProcessHostToLocalTransfer()
 	m_transferHost->DoTransfer(m_xferBuffer);
 
 	m_xferBuffer.clear();
+
+	auto [transferAddress, transferSize] = GsTransfer::GetDstRange(bltBuf, trxReg, trxPos);
+	InvalidatePredictedReadbacks(transferAddress, transferSize);
 }
 
 void CGSH_Vulkan::ProcessLocalToHostTransfer()
@@ -1441,7 +1639,8 @@ void CGSH_Vulkan::ProcessLocalToHostTransfer()
 
 		m_xferHistory.insert(std::make_pair(bltBuf, LOCAL_TO_HOST_XFER_HISTORY{}));
 		auto transfer = m_xferHistory.find(bltBuf);
-		transfer->second.MarkUsed();
+		auto& history = transfer->second;
+		history.MarkUsed();
 
 		auto [copyBase, copySize] = GsTransfer::GetSrcRange(bltBuf, trxReg, trxPos);
 
@@ -1457,33 +1656,31 @@ void CGSH_Vulkan::ProcessLocalToHostTransfer()
 			copySize = RAMSIZE - copyBase;
 		}
 
-		auto& srcBuffer = m_context->memoryBuffer;
-		auto& dstBuffer = m_context->memoryBufferTransfer;
-
-		auto commandBuffer = m_frameCommandBuffer->GetCommandBuffer();
+		bool hasPredictedCopy =
+		    (history.predictedCopySerial != 0) &&
+		    (history.copyBase == copyBase) &&
+		    (history.copySize == copySize);
 
+		if(hasPredictedCopy)
 		{
-			auto memoryBarrier = Framework::Vulkan::MemoryBarrier();
-			memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
-			memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-			m_context->device.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
-			                                       0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+			//Range was copied at the end of the previous frame, the copy is most likely
+			//done by now. If not, we only need to wait for that submission to complete.
+			if(!m_frameCommandBuffer->IsSerialComplete(history.predictedCopySerial))
+			{
+				m_frameCommandBuffer->WaitForSerial(history.predictedCopySerial);
+			}
 		}
-
+		else
 		{
-			VkBufferCopy bufferCopy = {};
-			bufferCopy.size = copySize;
-			bufferCopy.dstOffset = copyBase;
-			bufferCopy.srcOffset = copyBase;
-			m_context->device.vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &bufferCopy);
+			RecordMemoryReadback(copyBase, copySize);
+			m_frameCommandBuffer->WaitForSerial(m_frameCommandBuffer->GetCurrentSerial());
 		}
 
-		if(!transfer->second.IsRecurring())
-		{
-			m_frameCommandBuffer->Flush();
-			m_context->device.vkQueueWaitIdle(m_context->queue);
-		}
+		history.copyBase = copyBase;
+		history.copySize = copySize;
+		history.predictedCopySerial = 0;
+
+		auto& dstBuffer = m_context->memoryBufferTransfer;
 
 		void* bufferPtr = nullptr;
 		auto result = m_context->device.vkMapMemory(m_context->device, dstBuffer.GetMemory(), copyBase, copySize, 0, &bufferPtr);
@@ -1495,6 +1692,67 @@ void CGSH_Vulkan::ProcessLocalToHostTransfer()
 	}
 }
 
+void CGSH_Vulkan::RecordMemoryReadback(uint32 copyBase, uint32 copySize)
+{
+	auto& srcBuffer = m_context->memoryBuffer;
+	auto& dstBuffer = m_context->memoryBufferTransfer;
+
+	auto commandBuffer = m_frameCommandBuffer->GetCommandBuffer();
+
+	{
+		auto memoryBarrier = Framework::Vulkan::MemoryBarrier();
+		memoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		memoryBarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+
+		m_context->device.vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT, VK_PIPELINE_STAGE_ALL_GRAPHICS_BIT,
+		                                       0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	{
+		VkBufferCopy bufferCopy = {};
+		bufferCopy.size = copySize;
+		bufferCopy.dstOffset = copyBase;
+		bufferCopy.srcOffset = copyBase;
+		m_context->device.vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &bufferCopy);
+	}
+}
+
+void CGSH_Vulkan::IssuePredictedReadbacks()
+{
+	//Games reading back the same area every frame would stall the emulator waiting for the GPU.
+	//Copy those areas at the end of the frame, the next read will be served from that copy.
+	bool readsEnabled = CAppConfig::GetInstance().GetPreferenceBoolean(PREF_CGSHANDLER_GS_RAM_READS_ENABLED);
+	if(!readsEnabled) return;
+
+	bool renderPassFlushed = false;
+	for(auto& xferHistoryPair : m_xferHistory)
+	{
+		auto& history = xferHistoryPair.second;
+		if(!history.IsRecurring() || (history.copySize == 0)) continue;
+		if(!renderPassFlushed)
+		{
+			m_draw->FlushRenderPass();
+			renderPassFlushed = true;
+		}
+		RecordMemoryReadback(history.copyBase, history.copySize);
+		history.predictedCopySerial = m_frameCommandBuffer->GetCurrentSerial();
+	}
+}
+
+void CGSH_Vulkan::InvalidatePredictedReadbacks(uint32 address, uint32 size)
+{
+	for(auto& xferHistoryPair : m_xferHistory)
+	{
+		auto& history = xferHistoryPair.second;
+		if(history.predictedCopySerial == 0) continue;
+		bool overlaps = (address < (history.copyBase + history.copySize)) && (history.copyBase < (address + size));
+		if(overlaps)
+		{
+			history.predictedCopySerial = 0;
+		}
+	}
+}
+
 void CGSH_Vulkan::ProcessLocalToLocalTransfer()
 {
 	//Flush previous cached info
@@ -13,6 +13,7 @@
 #include <vector>
 #include <map>
 #include <cstring>
+#include "filesystem_def.h"
 #include "../GSHandler.h"
 #include "../GsDebuggerInterface.h"
 #include "../GsCachedArea.h"
@@ -106,6 +107,13 @@ private:
 		std::array<bool, MAX_FRAME_COUNT> used = {};
 		int frameCount = 0;
 
+		//Range read by the last transfer, copied ahead of time at the end of
+		//frames if the transfer is recurring
+		uint32 copyBase = 0;
+		uint32 copySize = 0;
+		//Submission serial of the copy made ahead of time (0 if none is available)
+		uint64 predictedCopySerial = 0;
+
 		void Advance()
 		{
 			frameCount++;
@@ -139,6 +147,10 @@ private:
 
 	virtual void PresentBackbuffer() = 0;
 
+	void RecordMemoryReadback(uint32, uint32);
+	void IssuePredictedReadbacks();
+	void InvalidatePredictedReadbacks(uint32, uint32);
+
 	std::vector<VkPhysicalDevice> GetPhysicalDevices();
 	uint32 GetPhysicalDeviceIndex(const std::vector<VkPhysicalDevice>&) const;
 	std::vector<uint32_t> GetRenderQueueFamilies(VkPhysicalDevice);
@@ -148,6 +160,12 @@ private:
 	void CreateDescriptorPool();
 	void CreateMemoryBuffer();
 	void CreateClutBuffer();
+	void CreatePipelineCache();
+	void SavePipelineCache();
+
+	std::string GetDrawPipelineCapsDriverString();
+	void PrewarmDrawPipelines();
+	void SaveDrawPipelineCapsList();
 
 	void ProcessPrim(uint64);
 	void VertexKick(uint8, uint64);
@@ -237,6 +255,9 @@ private:
 
 	uint8* m_memoryCache = nullptr;
 
+	fs::path m_pipelineCachePath;
+	fs::path m_drawPipelineCapsPath;
+
 	//Draw context
 	VERTEX m_vtxBuffer[3];
 	uint32 m_vtxCount = 0;
@@ -339,7 +339,7 @@ PIPELINE CClutLoad::CreateLoadPipeline(const PIPELINE_CAPS& caps)
 		createInfo.stage.module = loadShader;
 		createInfo.layout = loadPipeline.pipelineLayout;
 
-		result = m_context->device.vkCreateComputePipelines(m_context->device, VK_NULL_HANDLE, 1, &createInfo, nullptr, &loadPipeline.pipeline);
+		result = m_context->device.vkCreateComputePipelines(m_context->device, m_context->pipelineCache, 1, &createInfo, nullptr, &loadPipeline.pipeline);
 		CHECKVULKANERROR(result);
 	}
 
@@ -49,6 +49,9 @@ CDraw::CDraw(const ContextPtr& context, const FrameCommandBufferPtr& frameComman
 
 CDraw::~CDraw()
 {
+	//Derived classes must stop the worker since it calls into them
+	assert(!m_prewarmThread.joinable());
+	assert(m_prewarmedPipelines.empty());
 	for(auto& frame : m_frames)
 	{
 		m_context->device.vkUnmapMemory(m_context->device, frame.vertexBuffer.GetMemory());
@@ -267,6 +270,69 @@ void CDraw::PostFlushFrameCommandBuffer()
 	m_mipParamsIndex = 0;
 }
 
+void CDraw::PrewarmPipelines(PipelineCapsList capsList)
+{
+	assert(!m_prewarmThread.joinable());
+	if(capsList.empty()) return;
+	m_prewarmStopRequested = false;
+	m_prewarmThread = std::thread(
+	    [this, capsList = std::move(capsList)]() {
+		    for(auto capsInt : capsList)
+		    {
+			    if(m_prewarmStopRequested) break;
+			    auto caps = make_convertible<PIPELINE_CAPS>(capsInt);
+			    auto pipeline = CreateDrawPipeline(caps);
+			    std::lock_guard<std::mutex> prewarmLock(m_prewarmMutex);
+			    m_prewarmedPipelines.push_back(std::make_pair(capsInt, pipeline));
+		    }
+	    });
+}
+
+void CDraw::StopPrewarmingPipelines()
+{
+	if(!m_prewarmThread.joinable()) return;
+	m_prewarmStopRequested = true;
+	m_prewarmThread.join();
+	MergePrewarmedPipelines();
+}
+
+CDraw::PipelineCapsList CDraw::GetPipelineCapsList()
+{
+	MergePrewarmedPipelines();
+	return m_pipelineCache.GetKeys();
+}
+
+const PIPELINE* CDraw::GetDrawPipeline(const PIPELINE_CAPS& caps)
+{
+	if(auto pipeline = m_pipelineCache.TryGetPipeline(caps))
+	{
+		return pipeline;
+	}
+	//Worker might have compiled it already
+	MergePrewarmedPipelines();
+	if(auto pipeline = m_pipelineCache.TryGetPipeline(caps))
+	{
+		return pipeline;
+	}
+	return m_pipelineCache.RegisterPipeline(caps, CreateDrawPipeline(caps));
+}
+
+void CDraw::MergePrewarmedPipelines()
+{
+	std::lock_guard<std::mutex> prewarmLock(m_prewarmMutex);
+	for(const auto& prewarmedPipeline : m_prewarmedPipelines)
+	{
+		if(m_pipelineCache.TryGetPipeline(prewarmedPipeline.first))
+		{
+			//We had to create it ourselves before the worker got to it
+			PipelineCache::DestroyPipeline(m_context->device, prewarmedPipeline.second);
+			continue;
+		}
+		m_pipelineCache.RegisterPipeline(prewarmedPipeline.first, prewarmedPipeline.second);
+	}
+	m_prewarmedPipelines.clear();
+}
+
 std::vector<VkVertexInputAttributeDescription> CDraw::GetVertexAttributes()
 {
 	std::vector<VkVertexInputAttributeDescription> vertexAttributes;
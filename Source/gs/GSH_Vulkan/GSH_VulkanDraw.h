@@ -1,6 +1,10 @@
 #pragma once
 
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include "GSH_VulkanContext.h"
 #include "GSH_VulkanFrameCommandBuffer.h"
 #include "GSH_VulkanPipelineCache.h"
@@ -21,6 +25,7 @@ namespace GSH_Vulkan
 		};
 
 		typedef uint64 PipelineCapsInt;
+		typedef std::vector<PipelineCapsInt> PipelineCapsList;
 
 		enum PIPELINE_PRIMITIVE_TYPE
 		{
@@ -107,6 +112,10 @@ namespace GSH_Vulkan
 		void PreFlushFrameCommandBuffer() override;
 		void PostFlushFrameCommandBuffer() override;
 
+		void PrewarmPipelines(PipelineCapsList);
+		void StopPrewarmingPipelines();
+		PipelineCapsList GetPipelineCapsList();
+
 	protected:
 		enum
 		{
@@ -195,7 +204,12 @@ namespace GSH_Vulkan
 			DRAW_PIPELINE_MIPPARAMS_UNIFORMS* mipParamsBufferPtr = nullptr;
 		};
 
+		typedef std::pair<PipelineCapsInt, PIPELINE> PrewarmedPipeline;
+
 		static std::vector<VkVertexInputAttributeDescription> GetVertexAttributes();
+		virtual PIPELINE CreateDrawPipeline(const PIPELINE_CAPS&) = 0;
+		const PIPELINE* GetDrawPipeline(const PIPELINE_CAPS&);
+		void MergePrewarmedPipelines();
 		Framework::Vulkan::CShaderModule CreateVertexShader(const PIPELINE_CAPS&);
 
 		static constexpr float DEPTH_MAX = 4294967296.0f;
@@ -203,6 +217,12 @@ namespace GSH_Vulkan
 		ContextPtr m_context;
 		FrameCommandBufferPtr m_frameCommandBuffer;
 		PipelineCache m_pipelineCache;
+
+		std::thread m_prewarmThread;
+		std::mutex m_prewarmMutex;
+		std::vector<PrewarmedPipeline> m_prewarmedPipelines;
+		std::atomic<bool> m_prewarmStopRequested = false;
+
 		DescriptorSetCache m_descriptorSetCache;
 
 		FRAMECONTEXT m_frames[MAX_FRAMES];
@@ -31,6 +31,8 @@ CDrawDesktop::CDrawDesktop(const ContextPtr& context, const FrameCommandBufferPt
 
 CDrawDesktop::~CDrawDesktop()
 {
+	//Worker needs our render pass, make sure it's done before we tear it down
+	StopPrewarmingPipelines();
 	m_context->device.vkDestroyFramebuffer(m_context->device, m_framebuffer, nullptr);
 	m_context->device.vkDestroyRenderPass(m_context->device, m_renderPass, nullptr);
 	m_context->device.vkDestroyImageView(m_context->device, m_drawImageView, nullptr);
@@ -301,7 +303,7 @@ PIPELINE CDrawDesktop::CreateDrawPipeline(const PIPELINE_CAPS& caps)
 	pipelineCreateInfo.renderPass = m_renderPass;
 	pipelineCreateInfo.layout = drawPipeline.pipelineLayout;
 
-	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &drawPipeline.pipeline);
+	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, m_context->pipelineCache, 1, &pipelineCreateInfo, nullptr, &drawPipeline.pipeline);
 	CHECKVULKANERROR(result);
 
 	return drawPipeline;
@@ -967,11 +969,7 @@ void CDrawDesktop::FlushVertices()
 	}
 
 	//Find pipeline and create it if we've never encountered it before
-	auto drawPipeline = m_pipelineCache.TryGetPipeline(m_pipelineCaps);
-	if(!drawPipeline)
-	{
-		drawPipeline = m_pipelineCache.RegisterPipeline(m_pipelineCaps, CreateDrawPipeline(m_pipelineCaps));
-	}
+	auto drawPipeline = GetDrawPipeline(m_pipelineCaps);
 
 	{
 		VkViewport viewport = {};
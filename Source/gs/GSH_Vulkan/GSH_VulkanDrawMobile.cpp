@@ -42,6 +42,8 @@ CDrawMobile::CDrawMobile(const ContextPtr& context, const FrameCommandBufferPtr&
 
 CDrawMobile::~CDrawMobile()
 {
+	//Worker needs our render pass, make sure it's done before we tear it down
+	StopPrewarmingPipelines();
 	m_context->device.vkDestroyFramebuffer(m_context->device, m_framebuffer, nullptr);
 	m_context->device.vkDestroyRenderPass(m_context->device, m_renderPass, nullptr);
 	m_context->device.vkDestroyImageView(m_context->device, m_drawColorImageView, nullptr);
@@ -188,11 +190,7 @@ void CDrawMobile::FlushVertices()
 	}
 
 	//Find pipeline and create it if we've never encountered it before
-	auto drawPipeline = m_pipelineCache.TryGetPipeline(m_pipelineCaps);
-	if(!drawPipeline)
-	{
-		drawPipeline = m_pipelineCache.RegisterPipeline(m_pipelineCaps, CreateDrawPipeline(m_pipelineCaps));
-	}
+	auto drawPipeline = GetDrawPipeline(m_pipelineCaps);
 
 	{
 		auto memoryBarrier = Framework::Vulkan::MemoryBarrier();
@@ -830,7 +828,7 @@ PIPELINE CDrawMobile::CreateDrawPipeline(const PIPELINE_CAPS& caps)
 	pipelineCreateInfo.renderPass = m_renderPass;
 	pipelineCreateInfo.layout = drawPipeline.pipelineLayout;
 
-	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &drawPipeline.pipeline);
+	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, m_context->pipelineCache, 1, &pipelineCreateInfo, nullptr, &drawPipeline.pipeline);
 	CHECKVULKANERROR(result);
 
 	return drawPipeline;
@@ -1384,7 +1382,7 @@ PIPELINE CDrawMobile::CreateLoadPipeline(const PIPELINE_CAPS& caps)
 	pipelineCreateInfo.renderPass = m_renderPass;
 	pipelineCreateInfo.layout = loadPipeline.pipelineLayout;
 
-	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &loadPipeline.pipeline);
+	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, m_context->pipelineCache, 1, &pipelineCreateInfo, nullptr, &loadPipeline.pipeline);
 	CHECKVULKANERROR(result);
 
 	return loadPipeline;
@@ -1543,7 +1541,7 @@ PIPELINE CDrawMobile::CreateStorePipeline(const PIPELINE_CAPS& caps)
 	pipelineCreateInfo.renderPass = m_renderPass;
 	pipelineCreateInfo.layout = storePipeline.pipelineLayout;
 
-	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &storePipeline.pipeline);
+	result = m_context->device.vkCreateGraphicsPipelines(m_context->device, m_context->pipelineCache, 1, &pipelineCreateInfo, nullptr, &storePipeline.pipeline);
 	CHECKVULKANERROR(result);
 
 	return storePipeline;
@@ -26,7 +26,7 @@ namespace GSH_Vulkan
 		void CreateRenderPass();
 		void CreateDrawImages();
 
-		PIPELINE CreateDrawPipeline(const PIPELINE_CAPS&);
+		PIPELINE CreateDrawPipeline(const PIPELINE_CAPS&) override;
 		Framework::Vulkan::CShaderModule CreateDrawFragmentShader(const PIPELINE_CAPS&);
 
 		static PIPELINE_CAPS MakeLoadStorePipelineCaps(const PIPELINE_CAPS&);
@@ -1,3 +1,4 @@
+#include <cassert>
 #include "GSH_VulkanFrameCommandBuffer.h"
 #include "vulkan/StructDefs.h"
 
@@ -36,7 +37,8 @@ void CFrameCommandBuffer::RegisterWriter(IFrameCommandBufferWriter* writer)
 
 void CFrameCommandBuffer::BeginFrame()
 {
-	const auto& frame = m_frames[m_currentFrame];
+	auto& frame = m_frames[m_currentFrame];
+	frame.serial = ++m_currentSerial;
 
 	auto result = VK_SUCCESS;
 
@@ -113,3 +115,42 @@ uint32 CFrameCommandBuffer::GetCurrentFrame() const
 {
 	return m_currentFrame;
 }
+
+uint64 CFrameCommandBuffer::GetCurrentSerial() const
+{
+	return m_currentSerial;
+}
+
+bool CFrameCommandBuffer::IsSerialComplete(uint64 serial)
+{
+	if(serial >= m_currentSerial) return false;
+	auto frame = FindFrameFromSerial(serial);
+	if(!frame)
+	{
+		//Frame context was recycled, which only happens once its fence is signaled
+		return true;
+	}
+	return m_context->device.vkGetFenceStatus(m_context->device, frame->execCompleteFence) == VK_SUCCESS;
+}
+
+void CFrameCommandBuffer::WaitForSerial(uint64 serial)
+{
+	if(serial >= m_currentSerial)
+	{
+		assert(serial == m_currentSerial);
+		Flush();
+	}
+	auto frame = FindFrameFromSerial(serial);
+	if(!frame) return;
+	auto result = m_context->device.vkWaitForFences(m_context->device, 1, &frame->execCompleteFence, VK_TRUE, UINT64_MAX);
+	CHECKVULKANERROR(result);
+}
+
+CFrameCommandBuffer::FRAMECONTEXT* CFrameCommandBuffer::FindFrameFromSerial(uint64 serial)
+{
+	for(auto& frame : m_frames)
+	{
+		if(frame.serial == serial) return &frame;
+	}
+	return nullptr;
+}
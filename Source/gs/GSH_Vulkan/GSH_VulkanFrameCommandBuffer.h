@@ -35,19 +35,28 @@ namespace GSH_Vulkan
 		VkCommandBuffer GetCommandBuffer();
 		uint32 GetCurrentFrame() const;
 
+		//Serials identify submissions, commands recorded now will complete with the current serial
+		uint64 GetCurrentSerial() const;
+		bool IsSerialComplete(uint64);
+		void WaitForSerial(uint64);
+
 	private:
 		struct FRAMECONTEXT
 		{
 			VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
 			VkFence execCompleteFence = VK_NULL_HANDLE;
+			uint64 serial = 0;
 		};
 
+		FRAMECONTEXT* FindFrameFromSerial(uint64);
+
 		ContextPtr m_context;
 
 		std::vector<IFrameCommandBufferWriter*> m_writers;
 
 		FRAMECONTEXT m_frames[MAX_FRAMES];
 		uint32 m_currentFrame = 0;
+		uint64 m_currentSerial = 0;
 
 		uint32 m_flushCount = 0;
 	};
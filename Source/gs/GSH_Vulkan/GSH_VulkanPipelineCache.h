@@ -2,6 +2,7 @@
 
 #include "vulkan/Device.h"
 #include <unordered_map>
+#include <vector>
 
 namespace GSH_Vulkan
 {
@@ -25,13 +26,17 @@ namespace GSH_Vulkan
 		{
 			for(const auto& pipelinePair : m_pipelines)
 			{
-				auto& pipeline = pipelinePair.second;
-				m_device->vkDestroyPipeline(*m_device, pipeline.pipeline, nullptr);
-				m_device->vkDestroyPipelineLayout(*m_device, pipeline.pipelineLayout, nullptr);
-				m_device->vkDestroyDescriptorSetLayout(*m_device, pipeline.descriptorSetLayout, nullptr);
+				DestroyPipeline(*m_device, pipelinePair.second);
 			}
 		}
 
+		static void DestroyPipeline(const Framework::Vulkan::CDevice& device, const PIPELINE& pipeline)
+		{
+			device.vkDestroyPipeline(device, pipeline.pipeline, nullptr);
+			device.vkDestroyPipelineLayout(device, pipeline.pipelineLayout, nullptr);
+			device.vkDestroyDescriptorSetLayout(device, pipeline.descriptorSetLayout, nullptr);
+		}
+
 		const PIPELINE* TryGetPipeline(const KeyType& key) const
 		{
 			auto pipelineIterator = m_pipelines.find(key);
@@ -45,6 +50,17 @@ namespace GSH_Vulkan
 			return TryGetPipeline(key);
 		}
 
+		std::vector<KeyType> GetKeys() const
+		{
+			std::vector<KeyType> keys;
+			keys.reserve(m_pipelines.size());
+			for(const auto& pipelinePair : m_pipelines)
+			{
+				keys.push_back(pipelinePair.first);
+			}
+			return keys;
+		}
+
 	private:
 		typedef std::unordered_map<KeyType, PIPELINE> PipelineMap;
 
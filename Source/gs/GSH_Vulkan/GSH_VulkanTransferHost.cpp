@@ -520,7 +520,7 @@ PIPELINE CTransferHost::CreateXferPipeline(const PIPELINE_CAPS& caps)
 		createInfo.stage.module = xferShader;
 		createInfo.layout = xferPipeline.pipelineLayout;
 
-		result = m_context->device.vkCreateComputePipelines(m_context->device, VK_NULL_HANDLE, 1, &createInfo, nullptr, &xferPipeline.pipeline);
+		result = m_context->device.vkCreateComputePipelines(m_context->device, m_context->pipelineCache, 1, &createInfo, nullptr, &xferPipeline.pipeline);
 		CHECKVULKANERROR(result);
 	}
 
@@ -9,6 +9,7 @@
 #include "../ee/INTC.h"
 #include "GSHandler.h"
 #include "GsPixelFormats.h"
+#include "GsTransferRange.h"
 #include "string_format.h"
 #include "ThreadUtils.h"
 
@@ -152,6 +153,7 @@ void CGSHandler::ResetBase()
 	memset(m_nReg, 0, sizeof(uint64) * 0x80);
 	memset(m_pRAM, 0, RAMSIZE);
 	memset(m_pCLUT, 0, CLUTSIZE);
+	InvalidateClutLoadCache();
 	memset(&m_trxCtx, 0, sizeof(m_trxCtx));
 	m_nPMODE = 0;
 	m_nSMODE2 = 0x3; // Interlacing with fullframe
@@ -179,6 +181,11 @@ void CGSHandler::ResetBase()
 	m_writeBufferSubmitIndex = 0;
 	m_writeBufferIndex = 0;
 	m_currentWriteBuffer = m_writeBuffers[m_writeBufferIndex];
+	for(auto& imageDataArena : m_imageDataArenas)
+	{
+		imageDataArena.slabIndex = 0;
+		imageDataArena.slabOffset = 0;
+	}
 }
 
 void CGSHandler::ResetImpl()
@@ -306,6 +313,8 @@ void CGSHandler::LoadState(Framework::CZipArchiveReader& archive)
 		m_nCBP1 = registerFile.GetRegister32(STATE_REG_CBP1);
 	}
 
+	InvalidateClutLoadCache();
+
 	SendGSCall([&]() { WriteBackMemoryCache(); });
 }
 
@@ -314,6 +323,7 @@ void CGSHandler::Copy(CGSHandler* source)
 	source->SendGSCall([source]() { source->SyncMemoryCache(); }, true);
 
 	memcpy(GetRam(), source->GetRam(), RAMSIZE);
+	InvalidateClutLoadCache();
 	memcpy(m_nReg, source->m_nReg, sizeof(uint64) * CGSHandler::REGISTER_MAX);
 	m_trxCtx = source->m_trxCtx;
 
@@ -378,7 +388,10 @@ void CGSHandler::InitFromFrameDump(CFrameDump* frameDump)
 	memcpy(GetRegisters(), frameDump->GetInitialGsRegisters(), CGSHandler::REGISTER_MAX * sizeof(uint64));
 	SetSMODE2(frameDump->GetInitialSMODE2());
 
-	SendGSCall([&]() { WriteBackMemoryCache(); });
+	SendGSCall([&]() {
+		InvalidateClutLoadCache();
+		WriteBackMemoryCache();
+	});
 }
 
 bool CGSHandler::GetDrawEnabled() const
@@ -629,7 +642,7 @@ void CGSHandler::FeedImageData(const void* data, uint32 length)
 	//Allocate 0x10 more bytes to allow transfer handlers
 	//to read beyond the actual length of the buffer (ie.: PSMCT24)
 
-	uint8* imageData = new uint8[length + 0x10];
+	uint8* imageData = AllocateImageData(length + 0x10);
 	memcpy(imageData, data, length);
 	memset(imageData + length, 0, 0x10);
 
@@ -642,10 +655,38 @@ void CGSHandler::FeedImageData(const void* data, uint32 length)
 		    }
 #endif
 		    FeedImageDataImpl(imageData, length);
-		    delete[] imageData;
 	    });
 }
 
+uint8* CGSHandler::AllocateImageData(uint32 size)
+{
+	//Memory stays valid until the current write buffer is used again, at that
+	//point, the GS thread is guaranteed to be done with it (see Finish)
+	auto& arena = m_imageDataArenas[m_writeBufferIndex];
+	size = (size + 0xF) & ~0xF;
+	while(true)
+	{
+		if(arena.slabIndex == arena.slabs.size())
+		{
+			arena.slabs.emplace_back(std::max<uint32>(size, IMAGEDATA_SLAB_SIZE));
+		}
+		auto& slab = arena.slabs[arena.slabIndex];
+		if((arena.slabOffset == 0) && (slab.size() < size))
+		{
+			//Nothing was allocated from this slab during this frame, safe to grow it
+			slab.resize(size);
+		}
+		if((arena.slabOffset + size) <= slab.size())
+		{
+			auto result = slab.data() + arena.slabOffset;
+			arena.slabOffset += size;
+			return result;
+		}
+		arena.slabIndex++;
+		arena.slabOffset = 0;
+	}
+}
+
 void CGSHandler::ReadImageData(void* data, uint32 length)
 {
 	assert(m_writeBufferProcessIndex == m_writeBufferSize);
@@ -744,6 +785,8 @@ void CGSHandler::FlushWriteBuffer()
 	m_writeBufferIndex++;
 	m_writeBufferIndex %= MAX_INFLIGHT_FRAMES;
 	m_currentWriteBuffer = m_writeBuffers[m_writeBufferIndex];
+	m_imageDataArenas[m_writeBufferIndex].slabIndex = 0;
+	m_imageDataArenas[m_writeBufferIndex].slabOffset = 0;
 	//Nothing should be written to the buffer after that
 }
 
@@ -940,6 +983,13 @@ void CGSHandler::BeginTransfer()
 		else if(trxDir == 1)
 		{
 			ProcessLocalToHostTransfer();
+			//Some handlers write framebuffer contents back to RAM here
+			if((trxReg.nRRW != 0) && (trxReg.nRRH != 0))
+			{
+				auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+				auto [transferAddress, transferSize] = GsTransfer::GetSrcRange(bltBuf, trxReg, trxPos);
+				MarkRamWritten(transferAddress, transferSize);
+			}
 			CLog::GetInstance().Print(LOG_NAME, "Starting transfer from 0x%08X, buffer size %d, psm: %d, size (%dx%d)\r\n",
 			                          bltBuf.GetSrcPtr(), bltBuf.GetSrcWidth(), bltBuf.nSrcPsm, trxReg.nRRW, trxReg.nRRH);
 		}
@@ -948,6 +998,14 @@ void CGSHandler::BeginTransfer()
 	{
 		//Local to Local
 		ProcessLocalToLocalTransfer();
+		auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
+		auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+		auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+		if((trxReg.nRRW != 0) && (trxReg.nRRH != 0))
+		{
+			auto [transferAddress, transferSize] = GsTransfer::GetDstRange(bltBuf, trxReg, trxPos);
+			MarkRamWritten(transferAddress, transferSize);
+		}
 	}
 }
 
@@ -959,7 +1017,15 @@ void CGSHandler::BeginTransferWrite()
 void CGSHandler::TransferWrite(const uint8* imageData, uint32 length)
 {
 	auto bltBuf = make_convertible<BITBLTBUF>(m_nReg[GS_REG_BITBLTBUF]);
-	m_trxCtx.nDirty |= ((this)->*(m_transferWriteHandlers[bltBuf.nDstPsm]))(imageData, length);
+	bool dirty = ((this)->*(m_transferWriteHandlers[bltBuf.nDstPsm]))(imageData, length);
+	if(dirty)
+	{
+		auto trxReg = make_convertible<TRXREG>(m_nReg[GS_REG_TRXREG]);
+		auto trxPos = make_convertible<TRXPOS>(m_nReg[GS_REG_TRXPOS]);
+		auto [transferAddress, transferSize] = GsTransfer::GetDstRange(bltBuf, trxReg, trxPos);
+		MarkRamWritten(transferAddress, transferSize);
+	}
+	m_trxCtx.nDirty |= dirty;
 }
 
 bool CGSHandler::TransferWriteHandlerInvalid(const void* pData, uint32 nLength)
@@ -1478,16 +1544,148 @@ void CGSHandler::SyncCLUT(const TEX0& tex0)
 	{
 	case PSMT8:
 	case PSMT8H:
+		if(IsClutLoadCached(tex0, true)) break;
 		ReadCLUT8(tex0);
+		RegisterClutLoad(tex0, true);
 		break;
 	case PSMT4:
 	case PSMT4HH:
 	case PSMT4HL:
+		if(IsClutLoadCached(tex0, false)) break;
 		ReadCLUT4(tex0);
+		RegisterClutLoad(tex0, false);
 		break;
 	}
 }
 
+bool CGSHandler::IsClutLoadCached(const TEX0& tex0, bool idx8) const
+{
+	uint64 loadKey = MakeClutLoadKey(tex0, idx8);
+	uint32 segmentMask = GetClutLoadSegmentMask(tex0, idx8);
+	uint32 loadSerial = 0;
+	for(uint32 i = 0; i < CLUT_SEGMENT_COUNT; i++)
+	{
+		if((segmentMask & (1U << i)) == 0) continue;
+		const auto& segmentState = m_clutSegmentStates[i];
+		if(segmentState.loadKey != loadKey) return false;
+		loadSerial = segmentState.loadSerial;
+	}
+
+	auto [sourceAddress, sourceSize] = GetClutLoadSourceRange(tex0, idx8);
+	uint32 firstPage = sourceAddress / RAM_PAGE_SIZE;
+	uint32 lastPage = (sourceAddress + sourceSize - 1) / RAM_PAGE_SIZE;
+	for(uint32 page = firstPage; page <= lastPage; page++)
+	{
+		if(m_ramPageWriteSerials[page % RAM_PAGE_COUNT] > loadSerial) return false;
+	}
+
+	return true;
+}
+
+void CGSHandler::RegisterClutLoad(const TEX0& tex0, bool idx8)
+{
+	uint64 loadKey = MakeClutLoadKey(tex0, idx8);
+	uint32 segmentMask = GetClutLoadSegmentMask(tex0, idx8);
+	for(uint32 i = 0; i < CLUT_SEGMENT_COUNT; i++)
+	{
+		if((segmentMask & (1U << i)) == 0) continue;
+		auto& segmentState = m_clutSegmentStates[i];
+		segmentState.loadKey = loadKey;
+		segmentState.loadSerial = m_ramWriteSerial;
+	}
+}
+
+uint64 CGSHandler::MakeClutLoadKey(const TEX0& tex0, bool idx8) const
+{
+	uint64 key = 0;
+	key |= static_cast<uint64>(idx8 ? 1 : 0);
+	key |= static_cast<uint64>(tex0.nCBP) << 1;
+	key |= static_cast<uint64>(tex0.nCPSM) << 15;
+	key |= static_cast<uint64>(tex0.nCSM) << 19;
+	key |= static_cast<uint64>(tex0.nCSA) << 20;
+	if(tex0.nCSM != 0)
+	{
+		//CSM2 reads from an arbitrary location specified by TEXCLUT
+		auto texClut = make_convertible<TEXCLUT>(m_nReg[GS_REG_TEXCLUT]);
+		key |= static_cast<uint64>(texClut.nCBW) << 25;
+		key |= static_cast<uint64>(texClut.nCOU) << 31;
+		key |= static_cast<uint64>(texClut.nCOV) << 37;
+	}
+	return key;
+}
+
+uint32 CGSHandler::GetClutLoadSegmentMask(const TEX0& tex0, bool idx8) const
+{
+	//Must match the areas of the CLUT buffer written by ReadCLUT4 and ReadCLUT8
+	bool isCt32 = (tex0.nCSM == 0) && ((tex0.nCPSM == PSMCT32) || (tex0.nCPSM == PSMCT24));
+	if(idx8)
+	{
+		return isCt32 ? ~0U : 0xFFFF;
+	}
+	else if(tex0.nCSM != 0)
+	{
+		return 1;
+	}
+	else if(isCt32)
+	{
+		uint32 segment = tex0.nCSA & 0x0F;
+		return (1U << segment) | (1U << (segment + 0x10));
+	}
+	else
+	{
+		return 1U << (tex0.nCSA & 0x1F);
+	}
+}
+
+std::pair<uint32, uint32> CGSHandler::GetClutLoadSourceRange(const TEX0& tex0, bool idx8) const
+{
+	//Pixel indexors add page offsets to the CLUT pointer, a page worth of pixels can thus span two pages
+	uint32 clutPtr = tex0.GetCLUTPtr();
+	if(tex0.nCSM == 0)
+	{
+		//CSM1 CLUTs (16x16 at most) always fit in a single page
+		return std::make_pair(clutPtr, static_cast<uint32>(RAM_PAGE_SIZE));
+	}
+	else
+	{
+		//CSM2 only supports PSMCT16 (64x64 pages)
+		auto texClut = make_convertible<TEXCLUT>(m_nReg[GS_REG_TEXCLUT]);
+		uint32 pageY = texClut.GetOffsetV() / 64;
+		uint32 startPageX = texClut.GetOffsetU() / 64;
+		uint32 entryCount = idx8 ? 0x100 : 0x10;
+		uint32 endPageX = (texClut.GetOffsetU() + entryCount - 1) / 64;
+		uint32 startPage = (pageY * texClut.nCBW) + startPageX;
+		uint32 pageCount = endPageX - startPageX + 1;
+		return std::make_pair(clutPtr + (startPage * RAM_PAGE_SIZE), pageCount * RAM_PAGE_SIZE);
+	}
+}
+
+void CGSHandler::MarkRamWritten(uint32 address, uint32 size)
+{
+	if(size == 0) return;
+	m_ramWriteSerial++;
+	if(m_ramWriteSerial == 0)
+	{
+		//Serial wrapped around, start over
+		InvalidateClutLoadCache();
+		m_ramWriteSerial++;
+	}
+	uint32 firstPage = address / RAM_PAGE_SIZE;
+	uint32 lastPage = (address + size - 1) / RAM_PAGE_SIZE;
+	uint32 pageCount = std::min<uint32>(lastPage - firstPage + 1, RAM_PAGE_COUNT);
+	for(uint32 i = 0; i < pageCount; i++)
+	{
+		m_ramPageWriteSerials[(firstPage + i) % RAM_PAGE_COUNT] = m_ramWriteSerial;
+	}
+}
+
+void CGSHandler::InvalidateClutLoadCache()
+{
+	m_clutSegmentStates.fill(CLUT_SEGMENT_STATE());
+	m_ramPageWriteSerials.fill(0);
+	m_ramWriteSerial = 0;
+}
+
 bool CGSHandler::ProcessCLD(const TEX0& tex0)
 {
 	switch(tex0.nCLD)
@@ -860,6 +860,16 @@ public:
 		m_currentWriteBuffer[m_writeBufferSize++] = write;
 	}
 
+	//Returns space for multiple register writes that can be filled directly, null if there's not enough room
+	inline RegisterWrite* ReserveRegisterWrites(uint32 count)
+	{
+		assert((m_writeBufferSize + count) <= REGISTERWRITEBUFFER_SIZE);
+		if((m_writeBufferSize + count) > REGISTERWRITEBUFFER_SIZE) return nullptr;
+		auto writes = m_currentWriteBuffer + m_writeBufferSize;
+		m_writeBufferSize += count;
+		return writes;
+	}
+
 	void ProcessWriteBuffer(const CGsPacketMetadata*);
 	void SubmitWriteBuffer();
 	void FlushWriteBuffer();
@@ -918,6 +928,20 @@ protected:
 		REGISTERWRITEBUFFER_SUBMIT_THRESHOLD = 0x100
 	};
 
+	enum
+	{
+		IMAGEDATA_SLAB_SIZE = 0x400000,
+	};
+
+	//Keeps image data sent during a frame alive until the GS thread is done with it.
+	//Slabs are reused once the frame's write buffer comes around again.
+	struct IMAGEDATA_ARENA
+	{
+		std::vector<std::vector<uint8>> slabs;
+		uint32 slabIndex = 0;
+		uint32 slabOffset = 0;
+	};
+
 	enum LOD_CALC
 	{
 		LOD_CALC_DYNAMIC = 0,
@@ -1040,6 +1064,7 @@ protected:
 	virtual void MarkNewFrame();
 	virtual void WriteRegisterImpl(uint8, uint64);
 	void FeedImageDataImpl(const uint8*, uint32);
+	uint8* AllocateImageData(uint32);
 	void ReadImageDataImpl(void*, uint32);
 	void SubmitWriteBufferImpl(const RegisterWrite*, const RegisterWrite*);
 
@@ -1074,6 +1099,13 @@ protected:
 
 	virtual void SyncCLUT(const TEX0&);
 	bool ProcessCLD(const TEX0&);
+	bool IsClutLoadCached(const TEX0&, bool) const;
+	void RegisterClutLoad(const TEX0&, bool);
+	uint64 MakeClutLoadKey(const TEX0&, bool) const;
+	uint32 GetClutLoadSegmentMask(const TEX0&, bool) const;
+	std::pair<uint32, uint32> GetClutLoadSourceRange(const TEX0&, bool) const;
+	void MarkRamWritten(uint32, uint32);
+	void InvalidateClutLoadCache();
 	template <typename Indexor>
 	bool ReadCLUT4_16(const TEX0&);
 	template <typename Indexor>
@@ -1108,6 +1140,27 @@ protected:
 	uint32 m_nCBP0;
 	uint32 m_nCBP1;
 
+	//Remembers which CLUT load last filled each 16 entry segment of the CLUT buffer.
+	//A load is skipped if it would fill the same segments from GS RAM pages that
+	//weren't written since then.
+	enum
+	{
+		CLUT_SEGMENT_COUNT = 32,
+		CLUT_SEGMENT_ENTRIES = CLUTENTRYCOUNT / CLUT_SEGMENT_COUNT,
+		RAM_PAGE_SIZE = 0x2000,
+		RAM_PAGE_COUNT = RAMSIZE / RAM_PAGE_SIZE,
+	};
+
+	struct CLUT_SEGMENT_STATE
+	{
+		uint64 loadKey = ~0ULL;
+		uint32 loadSerial = 0;
+	};
+
+	std::array<CLUT_SEGMENT_STATE, CLUT_SEGMENT_COUNT> m_clutSegmentStates;
+	std::array<uint32, RAM_PAGE_COUNT> m_ramPageWriteSerials = {};
+	uint32 m_ramWriteSerial = 0;
+
 	uint32 m_drawCallCount = 0;
 
 	static constexpr int MAX_INFLIGHT_FRAMES = 2;
@@ -1119,6 +1172,8 @@ protected:
 	uint32 m_writeBufferProcessIndex = 0;
 	uint32 m_writeBufferSubmitIndex = 0;
 
+	IMAGEDATA_ARENA m_imageDataArenas[MAX_INFLIGHT_FRAMES];
+
 	CRT_MODE m_crtMode;
 	std::thread m_thread;
 	std::recursive_mutex m_registerMutex;
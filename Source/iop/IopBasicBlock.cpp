@@ -0,0 +1,13 @@
+#include "IopBasicBlock.h"
+#include "IdleLoopAnalysis.h"
+
+void CIopBasicBlock::CompileEpilog(CMipsJitter* jitter, bool loopsOnItself)
+{
+	uint32 idleLoopHead = IdleLoopAnalysis::GetIdleLoopHead(m_context, m_begin, m_end, IdleLoopAnalysis::ISA_R3000);
+	if(idleLoopHead != MIPS_INVALID_PC)
+	{
+		IdleLoopAnalysis::CompileIdleLoopCheck(jitter, idleLoopHead);
+	}
+
+	CBasicBlock::CompileEpilog(jitter, loopsOnItself);
+}
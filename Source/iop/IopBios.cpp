@@ -1,5 +1,6 @@
 #include <vector>
 #include <cstring>
+#include <algorithm>
 
 #include "string_format.h"
 #include "PtrStream.h"
@@ -155,6 +156,9 @@ void CIopBios::Reset(uint32 ramSize, const Iop::SifManPtr& sifMan)
 	m_cpu.m_State.nCOP0[CCOP_SCU::STATUS] |= CMIPS::STATUS_IE;
 
 	m_threads.FreeAll();
+	m_delayedThreads.clear();
+	m_vblankStartWaitThreads.clear();
+	m_vblankEndWaitThreads.clear();
 	m_semaphores.FreeAll();
 	m_intrHandlers.FreeAll();
 #ifdef DEBUGGER_INCLUDED
@@ -388,6 +392,8 @@ void CIopBios::LoadState(Framework::CZipArchiveReader& archive)
 
 	archive.BeginReadFile(STATE_MODULESTARTREQUESTS)->Read(m_moduleStartRequests, sizeof(m_moduleStartRequests));
 
+	RebuildThreadWaitLists();
+
 #ifdef _IOP_EMULATE_MODULES
 	//Make sure HLE modules are properly registered
 	for(const auto& loadedModule : m_loadedModules)
@@ -1285,10 +1291,9 @@ int32 CIopBios::DelayThread(uint32 delay)
 
 	THREAD* thread = GetThread(m_currentThreadId);
 	thread->nextActivateTime = GetCurrentTime() + MicroSecToClock(delay);
-	//TODO: Add a proper wait state to allow thread to be relinked
-	//at the end of the queue at the right moment
+	//Thread will be relinked at the end of its priority's queue when delay expires
 	UnlinkThread(thread->id);
-	LinkThread(thread->id);
+	AddDelayedThread(thread->id);
 	m_rescheduleNeeded = true;
 
 	return KERNEL_RESULT_OK;
@@ -1298,10 +1303,9 @@ void CIopBios::DelayThreadTicks(uint32 delay)
 {
 	auto thread = GetThread(m_currentThreadId);
 	thread->nextActivateTime = GetCurrentTime() + delay;
-	//TODO: Add a proper wait state to allow thread to be relinked
-	//at the end of the queue at the right moment
+	//Thread will be relinked at the end of its priority's queue when delay expires
 	UnlinkThread(thread->id);
-	LinkThread(thread->id);
+	AddDelayedThread(thread->id);
 	m_rescheduleNeeded = true;
 }
 
@@ -1744,6 +1748,7 @@ void CIopBios::SleepThreadTillVBlankStart()
 	THREAD* thread = GetThread(m_currentThreadId);
 	thread->status = THREAD_STATUS_WAIT_VBLANK_START;
 	UnlinkThread(thread->id);
+	m_vblankStartWaitThreads.push_back(thread->id);
 	m_rescheduleNeeded = true;
 }
 
@@ -1752,6 +1757,7 @@ void CIopBios::SleepThreadTillVBlankEnd()
 	THREAD* thread = GetThread(m_currentThreadId);
 	thread->status = THREAD_STATUS_WAIT_VBLANK_END;
 	UnlinkThread(thread->id);
+	m_vblankEndWaitThreads.push_back(thread->id);
 	m_rescheduleNeeded = true;
 }
 
@@ -1832,6 +1838,88 @@ void CIopBios::UnlinkThread(uint32 threadId)
 	}
 }
 
+void CIopBios::AddDelayedThread(uint32 threadId)
+{
+	auto thread = m_threads[threadId];
+	DELAYED_THREAD item;
+	item.activateTime = thread->nextActivateTime;
+	item.threadId = threadId;
+	m_delayedThreads.push_back(item);
+	std::push_heap(m_delayedThreads.begin(), m_delayedThreads.end(), &CIopBios::IsDelayedThreadLater);
+}
+
+void CIopBios::ActivateDelayedThreads()
+{
+	uint64 currentTime = GetCurrentTime();
+	while(!m_delayedThreads.empty() && (m_delayedThreads.front().activateTime < currentTime))
+	{
+		auto item = m_delayedThreads.front();
+		std::pop_heap(m_delayedThreads.begin(), m_delayedThreads.end(), &CIopBios::IsDelayedThreadLater);
+		m_delayedThreads.pop_back();
+		if(IsDelayedThreadStale(item)) continue;
+		//Thread might already be linked if its priority was changed while it was delayed
+		UnlinkThread(item.threadId);
+		LinkThread(item.threadId);
+	}
+}
+
+void CIopBios::PruneDelayedThreads()
+{
+	while(!m_delayedThreads.empty() && IsDelayedThreadStale(m_delayedThreads.front()))
+	{
+		std::pop_heap(m_delayedThreads.begin(), m_delayedThreads.end(), &CIopBios::IsDelayedThreadLater);
+		m_delayedThreads.pop_back();
+	}
+}
+
+bool CIopBios::IsDelayedThreadStale(const DELAYED_THREAD& item) const
+{
+	//Thread might have been deleted, terminated or delayed again since it was added
+	auto thread = m_threads[item.threadId];
+	if(!thread) return true;
+	if(thread->status != THREAD_STATUS_RUNNING) return true;
+	return thread->nextActivateTime != item.activateTime;
+}
+
+bool CIopBios::IsDelayedThreadLater(const DELAYED_THREAD& lhs, const DELAYED_THREAD& rhs)
+{
+	//Heap functions build a max heap, we want the earliest activation time on top
+	if(lhs.activateTime != rhs.activateTime)
+	{
+		return lhs.activateTime > rhs.activateTime;
+	}
+	return lhs.threadId > rhs.threadId;
+}
+
+void CIopBios::RebuildThreadWaitLists()
+{
+	m_delayedThreads.clear();
+	m_vblankStartWaitThreads.clear();
+	m_vblankEndWaitThreads.clear();
+
+	uint64 currentTime = GetCurrentTime();
+	for(auto thread : m_threads)
+	{
+		if(!thread) continue;
+		switch(thread->status)
+		{
+		case THREAD_STATUS_RUNNING:
+			if(currentTime <= thread->nextActivateTime)
+			{
+				UnlinkThread(thread->id);
+				AddDelayedThread(thread->id);
+			}
+			break;
+		case THREAD_STATUS_WAIT_VBLANK_START:
+			m_vblankStartWaitThreads.push_back(thread->id);
+			break;
+		case THREAD_STATUS_WAIT_VBLANK_END:
+			m_vblankEndWaitThreads.push_back(thread->id);
+			break;
+		}
+	}
+}
+
 void CIopBios::Reschedule()
 {
 	if((m_cpu.m_State.nCOP0[CCOP_SCU::STATUS] & CMIPS::STATUS_EXL) != 0)
@@ -1870,6 +1958,9 @@ void CIopBios::Reschedule()
 
 uint32 CIopBios::GetNextReadyThread()
 {
+	ActivateDelayedThreads();
+
+	//Delayed threads are kept out of the ready list, this will usually return the head
 	uint32 nextThreadId = ThreadLinkHead();
 	while(nextThreadId != 0)
 	{
@@ -1911,10 +2002,31 @@ void CIopBios::CountTicks(uint32 ticks)
 #endif
 }
 
+uint32 CIopBios::GetTicksUntilNextEvent()
+{
+	uint64 result = ~0U;
+	uint64 currentTime = GetCurrentTime();
+	ActivateDelayedThreads();
+	PruneDelayedThreads();
+	if(!m_delayedThreads.empty())
+	{
+		uint64 activateTime = m_delayedThreads.front().activateTime;
+		assert(activateTime >= currentTime);
+		result = std::min<uint64>(result, activateTime - currentTime + 1);
+	}
+#ifdef _IOP_EMULATE_MODULES
+	result = std::min<uint64>(result, m_cdvdman->GetTicksUntilNextEvent());
+	result = std::min<uint64>(result, m_mcserv->GetTicksUntilNextEvent());
+#endif
+	return static_cast<uint32>(result);
+}
+
 void CIopBios::NotifyVBlankStart()
 {
-	for(auto thread : m_threads)
+	for(auto threadId : m_vblankStartWaitThreads)
 	{
+		auto thread = m_threads[threadId];
+		//Thread might have been released or terminated since
 		if(!thread) continue;
 		if(thread->status == THREAD_STATUS_WAIT_VBLANK_START)
 		{
@@ -1922,12 +2034,15 @@ void CIopBios::NotifyVBlankStart()
 			LinkThread(thread->id);
 		}
 	}
+	m_vblankStartWaitThreads.clear();
 }
 
 void CIopBios::NotifyVBlankEnd()
 {
-	for(auto thread : m_threads)
+	for(auto threadId : m_vblankEndWaitThreads)
 	{
+		auto thread = m_threads[threadId];
+		//Thread might have been released or terminated since
 		if(!thread) continue;
 		if(thread->status == THREAD_STATUS_WAIT_VBLANK_END)
 		{
@@ -1935,6 +2050,7 @@ void CIopBios::NotifyVBlankEnd()
 			LinkThread(thread->id);
 		}
 	}
+	m_vblankEndWaitThreads.clear();
 #ifdef _IOP_EMULATE_MODULES
 	m_cdvdfsv->ProcessCommands(m_sifMan.get());
 	m_fileIo->ProcessCommands(m_sifMan.get());
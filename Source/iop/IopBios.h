@@ -4,6 +4,7 @@
 #include <list>
 #include <map>
 #include <set>
+#include <vector>
 #include "../MIPSAssembler.h"
 #include "../MIPS.h"
 #include "../ELF.h"
@@ -189,6 +190,7 @@ public:
 	void Reschedule();
 
 	void CountTicks(uint32) override;
+	uint32 GetTicksUntilNextEvent() override;
 	uint64 GetCurrentTime() const;
 	uint64 MilliSecToClock(uint32);
 	uint64 MicroSecToClock(uint32);
@@ -602,6 +604,14 @@ private:
 	typedef std::set<Iop::CModule*> ModuleSet;
 	typedef std::pair<uint32, uint32> ExecutableRange;
 
+	struct DELAYED_THREAD
+	{
+		uint64 activateTime = 0;
+		uint32 threadId = 0;
+	};
+	typedef std::vector<DELAYED_THREAD> DelayedThreadHeap;
+	typedef std::vector<uint32> ThreadIdList;
+
 	void LoadThreadContext(uint32);
 	void SaveThreadContext(uint32);
 	uint32 GetNextReadyThread();
@@ -610,6 +620,13 @@ private:
 	void LinkThread(uint32);
 	void UnlinkThread(uint32);
 
+	void AddDelayedThread(uint32);
+	void ActivateDelayedThreads();
+	void PruneDelayedThreads();
+	bool IsDelayedThreadStale(const DELAYED_THREAD&) const;
+	static bool IsDelayedThreadLater(const DELAYED_THREAD&, const DELAYED_THREAD&);
+	void RebuildThreadWaitLists();
+
 	uint32& ThreadLinkHead() const;
 	uint64& CurrentTime() const;
 	uint32& ModuleStartRequestHead() const;
@@ -664,6 +681,11 @@ private:
 
 	bool m_rescheduleNeeded = false;
 	ThreadList m_threads;
+
+	//Host side wait lists, not saved in states, rebuilt from thread states instead
+	DelayedThreadHeap m_delayedThreads;
+	ThreadIdList m_vblankStartWaitThreads;
+	ThreadIdList m_vblankEndWaitThreads;
 	MemoryBlockList m_memoryBlocks;
 	SemaphoreList m_semaphores;
 	EventFlagList m_eventFlags;
@@ -0,0 +1,14 @@
+#include "IopExecutor.h"
+#include "IopBasicBlock.h"
+
+CIopExecutor::CIopExecutor(CMIPS& context, uint32 maxAddress)
+    : CGenericMipsExecutor(context, maxAddress, BLOCK_CATEGORY_PS2_IOP)
+{
+}
+
+BasicBlockPtr CIopExecutor::BlockFactory(CMIPS& context, uint32 start, uint32 end)
+{
+	auto result = std::make_shared<CIopBasicBlock>(context, start, end, m_blockCategory);
+	result->Compile();
+	return result;
+}
@@ -18,6 +18,7 @@ namespace Iop
 		virtual void HandleException() = 0;
 		virtual void HandleInterrupt() = 0;
 		virtual void CountTicks(uint32) = 0;
+		virtual uint32 GetTicksUntilNextEvent() = 0;
 
 		virtual void NotifyVBlankStart() = 0;
 		virtual void NotifyVBlankEnd() = 0;
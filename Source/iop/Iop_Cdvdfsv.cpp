@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <cstring>
 #include "../Log.h"
 #include "../Ps2Const.h"
 #include "Iop_Cdvdfsv.h"
@@ -58,17 +59,27 @@ std::string CCdvdfsv::GetFunctionName(unsigned int) const
 	return "unknown";
 }
 
+static void ReadBlockToEeRam(CSifManPs2* sifManPs2, CISO9660* fileSystem, uint32 sector, uint32 eeAddress)
+{
+	static const uint32 sectorSize = 0x800;
+	assert(sifManPs2);
+	if(!sifManPs2) return;
+
+	//Read outside of the EE RAM write lock, EE can't compile blocks while it's held
+	uint8 sectorBuffer[sectorSize];
+	fileSystem->ReadBlock(sector, sectorBuffer);
+
+	auto writeLock = sifManPs2->PrepareEeRamWrite(eeAddress, sectorSize);
+	memcpy(sifManPs2->GetEeRam() + eeAddress, sectorBuffer, sectorSize);
+}
+
 void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 {
 	if(m_pendingCommand != COMMAND_NONE)
 	{
 		static const uint32 sectorSize = 0x800;
 
-		uint8* eeRam = nullptr;
-		if(auto sifManPs2 = dynamic_cast<CSifManPs2*>(sifMan))
-		{
-			eeRam = sifManPs2->GetEeRam();
-		}
+		auto sifManPs2 = dynamic_cast<CSifManPs2*>(sifMan);
 
 		if(m_pendingCommand == COMMAND_READ)
 		{
@@ -77,7 +88,7 @@ void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 				auto fileSystem = m_opticalMedia->GetFileSystem();
 				for(unsigned int i = 0; i < m_pendingReadCount; i++)
 				{
-					fileSystem->ReadBlock(m_pendingReadSector + i, eeRam + (m_pendingReadAddr + (i * sectorSize)));
+					ReadBlockToEeRam(sifManPs2, fileSystem, m_pendingReadSector + i, m_pendingReadAddr + (i * sectorSize));
 				}
 			}
 		}
@@ -99,7 +110,7 @@ void CCdvdfsv::ProcessCommands(CSifMan* sifMan)
 				auto fileSystem = m_opticalMedia->GetFileSystem();
 				for(unsigned int i = 0; i < m_pendingReadCount; i++)
 				{
-					fileSystem->ReadBlock(m_streamPos, eeRam + (m_pendingReadAddr + (i * sectorSize)));
+					ReadBlockToEeRam(sifManPs2, fileSystem, m_streamPos, m_pendingReadAddr + (i * sectorSize));
 					m_streamPos++;
 				}
 			}
@@ -429,6 +429,15 @@ void CCdvdman::CountTicks(uint32 ticks)
 	}
 }
 
+uint32 CCdvdman::GetTicksUntilNextEvent() const
+{
+	if(m_pendingCommand == COMMAND_NONE)
+	{
+		return ~0U;
+	}
+	return static_cast<uint32>(std::max<int32>(0, m_pendingCommandDelay));
+}
+
 void CCdvdman::SetOpticalMedia(COpticalMedia* opticalMedia)
 {
 	m_opticalMedia = opticalMedia;
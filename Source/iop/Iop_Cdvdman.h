@@ -50,6 +50,7 @@ namespace Iop
 		virtual void Invoke(CMIPS&, unsigned int) override;
 
 		void CountTicks(uint32);
+		uint32 GetTicksUntilNextEvent() const;
 		void SetOpticalMedia(COpticalMedia*);
 
 		void LoadState(Framework::CZipArchiveReader&) override;
@@ -97,6 +97,13 @@ void CDmac::ResumeDma(unsigned int channelIdx)
 	channel->ResumeDma();
 }
 
+bool CDmac::IsDmaActive(unsigned int channelIdx) const
+{
+	auto channel = m_channel[channelIdx];
+	if(channel == nullptr) return false;
+	return channel->IsTransferActive();
+}
+
 void CDmac::AssertLine(unsigned int line)
 {
 	if(line < 7)
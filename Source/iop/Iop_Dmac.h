@@ -59,6 +59,7 @@ namespace Iop
 		void SaveState(Framework::CZipArchiveWriter&);
 
 		void ResumeDma(unsigned int);
+		bool IsDmaActive(unsigned int) const;
 
 		void AssertLine(unsigned int);
 		uint8* GetRam();
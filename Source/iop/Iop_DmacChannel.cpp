@@ -53,6 +53,11 @@ void CChannel::SetReceiveFunction(const ReceiveFunctionType& receiveFunction)
 	m_receiveFunction = receiveFunction;
 }
 
+bool CChannel::IsTransferActive() const
+{
+	return (m_CHCR.tr != 0);
+}
+
 void CChannel::ResumeDma()
 {
 	if(m_CHCR.tr == 0) return;
@@ -58,6 +58,7 @@ namespace Iop
 			void Reset();
 			void SetReceiveFunction(const ReceiveFunctionType&);
 			void ResumeDma();
+			bool IsTransferActive() const;
 			uint32 ReadRegister(uint32);
 			void WriteRegister(uint32, uint32);
 
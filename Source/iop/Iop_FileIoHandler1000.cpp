@@ -242,7 +242,8 @@ void CFileIoHandler1000::FinishRequest(CMIPS& context)
 	auto moduleData = reinterpret_cast<MODULEDATA*>(m_iopRam + m_moduleDataAddr);
 
 	uint8* eeRam = nullptr;
-	if(auto sifManPs2 = dynamic_cast<CSifManPs2*>(&m_sifMan))
+	auto sifManPs2 = dynamic_cast<CSifManPs2*>(&m_sifMan);
+	if(sifManPs2)
 	{
 		eeRam = sifManPs2->GetEeRam();
 	}
@@ -256,15 +257,29 @@ void CFileIoHandler1000::FinishRequest(CMIPS& context)
 		done = true;
 		break;
 	case METHOD_ID_READ:
+	{
+		CSIF::EeRamWriteLock writeLock;
+		if(sifManPs2 && (result > 0))
+		{
+			writeLock = sifManPs2->PrepareEeRamWrite(moduleData->eeBufferAddr, result);
+		}
 		std::tie(done, result) = FinishReadRequest(moduleData, eeRam, result);
-		break;
+	}
+	break;
 	default:
 		break;
 	}
 
 	if(done)
 	{
-		*reinterpret_cast<uint32*>(eeRam + moduleData->resultAddr) = result;
+		{
+			CSIF::EeRamWriteLock writeLock;
+			if(sifManPs2)
+			{
+				writeLock = sifManPs2->PrepareEeRamWrite(moduleData->resultAddr, 4);
+			}
+			*reinterpret_cast<uint32*>(eeRam + moduleData->resultAddr) = result;
+		}
 		m_sifMan.SendCallReply(CFileIo::SIF_MODULE_ID, nullptr);
 		context.m_State.nGPR[CMIPS::V0].nV0 = 0;
 	}
@@ -530,6 +530,11 @@ void CFileIoHandler2200::SendPendingReply(uint8* ram)
 	//Send response
 	if(m_resultPtr[0] != 0)
 	{
+		CSIF::EeRamWriteLock writeLock;
+		if(auto sifManPs2 = dynamic_cast<CSifManPs2*>(&m_sifMan))
+		{
+			writeLock = sifManPs2->PrepareEeRamWrite(m_resultPtr[0], m_pendingReply.replySize);
+		}
 		memcpy(ram + m_resultPtr[0], m_pendingReply.buffer.data(), m_pendingReply.replySize);
 	}
 	SendSifReply();
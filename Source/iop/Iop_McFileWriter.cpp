@@ -0,0 +1,215 @@
+#include <cassert>
+#include <stdexcept>
+#include "Iop_McFileWriter.h"
+#include "string_format.h"
+#include "../Log.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Iop;
+
+#define LOG_NAME ("iop_mcfilewriter")
+
+#define TEMPORARY_FILE_EXTENSION (".mcwtmp")
+
+CMcFileWriter::CMcFileWriter()
+{
+	m_thread = std::thread([this]() { ThreadProc(); });
+}
+
+CMcFileWriter::~CMcFileWriter()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_terminate = true;
+	}
+	m_pendingCondition.notify_one();
+	//Worker will persist everything that is still pending before exiting
+	m_thread.join();
+}
+
+void CMcFileWriter::Write(const fs::path& path, std::vector<uint8> contents)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_failedFiles.erase(path);
+		m_pendingFiles[path] = std::move(contents);
+	}
+	m_pendingCondition.notify_one();
+}
+
+bool CMcFileWriter::GetPendingContents(const fs::path& path, std::vector<uint8>& contents) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	auto pendingFileIterator = m_pendingFiles.find(path);
+	if(pendingFileIterator != std::end(m_pendingFiles))
+	{
+		contents = pendingFileIterator->second;
+		return true;
+	}
+	if(m_writing && (m_writingPath == path))
+	{
+		contents = m_writingContents;
+		return true;
+	}
+	//Contents that failed to be written are more recent than what's on disk
+	auto failedFileIterator = m_failedFiles.find(path);
+	if(failedFileIterator != std::end(m_failedFiles))
+	{
+		contents = failedFileIterator->second;
+		return true;
+	}
+	return false;
+}
+
+bool CMcFileWriter::Sync()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idleCondition.wait(lock, [this]() { return m_pendingFiles.empty() && !m_writing; });
+	return m_failedFiles.empty();
+}
+
+bool CMcFileWriter::HasFailed(const fs::path& path) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_failedFiles.find(path) != std::end(m_failedFiles);
+}
+
+bool CMcFileWriter::IsTemporaryFile(const fs::path& path)
+{
+	return path.extension() == TEMPORARY_FILE_EXTENSION;
+}
+
+void CMcFileWriter::ThreadProc()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while(true)
+	{
+		m_pendingCondition.wait(lock, [this]() { return !m_pendingFiles.empty() || m_terminate; });
+		if(m_pendingFiles.empty())
+		{
+			assert(m_terminate);
+			break;
+		}
+
+		auto pendingFileIterator = std::begin(m_pendingFiles);
+		m_writingPath = pendingFileIterator->first;
+		m_writingContents = std::move(pendingFileIterator->second);
+		m_pendingFiles.erase(pendingFileIterator);
+		m_writing = true;
+
+		//Nobody modifies the contents being written, they can be accessed without holding the lock
+		lock.unlock();
+		bool succeeded = true;
+		try
+		{
+			Persist(m_writingPath, m_writingContents);
+		}
+		catch(const std::exception& exception)
+		{
+			CLog::GetInstance().Warn(LOG_NAME, "Failed to write '%s': %s\r\n", m_writingPath.string().c_str(), exception.what());
+			succeeded = false;
+		}
+		lock.lock();
+
+		//Keep failed contents around unless a more recent version was submitted in the meantime
+		if(!succeeded && (m_pendingFiles.find(m_writingPath) == std::end(m_pendingFiles)))
+		{
+			m_failedFiles[m_writingPath] = std::move(m_writingContents);
+		}
+
+		m_writing = false;
+		m_writingContents.clear();
+		if(m_pendingFiles.empty())
+		{
+			m_idleCondition.notify_all();
+		}
+	}
+}
+
+//Contents need to be on disk before the file is renamed, otherwise a crash
+//might leave an empty file in place of the previous version of the save
+static void WriteFileSynced(const fs::path& path, const std::vector<uint8>& contents)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error(string_format("Failed to create file (error = %d).", GetLastError()));
+	}
+	DWORD written = 0;
+	bool succeeded = contents.empty() ||
+	                 (WriteFile(file, contents.data(), static_cast<DWORD>(contents.size()), &written, nullptr) && (written == contents.size()));
+	succeeded = succeeded && FlushFileBuffers(file);
+	DWORD error = GetLastError();
+	CloseHandle(file);
+	if(!succeeded)
+	{
+		throw std::runtime_error(string_format("Failed to write file (error = %d).", error));
+	}
+#else
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(fd < 0)
+	{
+		throw std::runtime_error(string_format("Failed to create file (errno = %d).", errno));
+	}
+	size_t offset = 0;
+	int error = 0;
+	while(offset < contents.size())
+	{
+		ssize_t written = write(fd, contents.data() + offset, contents.size() - offset);
+		if(written < 0)
+		{
+			if(errno == EINTR) continue;
+			error = errno;
+			break;
+		}
+		offset += written;
+	}
+	if((error == 0) && (fsync(fd) != 0))
+	{
+		error = errno;
+	}
+	if((close(fd) != 0) && (error == 0))
+	{
+		error = errno;
+	}
+	if(error != 0)
+	{
+		throw std::runtime_error(string_format("Failed to write file (errno = %d).", error));
+	}
+#endif
+}
+
+void CMcFileWriter::Persist(const fs::path& path, const std::vector<uint8>& contents)
+{
+	auto temporaryPath = path;
+	temporaryPath += TEMPORARY_FILE_EXTENSION;
+	try
+	{
+		WriteFileSynced(temporaryPath, contents);
+		fs::rename(temporaryPath, path);
+	}
+	catch(...)
+	{
+		std::error_code errorCode;
+		fs::remove(temporaryPath, errorCode);
+		throw;
+	}
+
+#ifndef _WIN32
+	//Make sure the rename itself is persisted, not fatal if it can't be done
+	int dirFd = open(path.parent_path().c_str(), O_RDONLY);
+	if(dirFd >= 0)
+	{
+		fsync(dirFd);
+		close(dirFd);
+	}
+#endif
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Types.h"
+#include "filesystem_def.h"
+
+namespace Iop
+{
+	//Persists memory card files on a worker thread. Each submission contains the whole
+	//contents of a file, submissions made to a file that hasn't been written yet replace
+	//the previous ones. Files are written and synced to a temporary file first and then
+	//renamed over the destination, so an interrupted write never leaves a partially written
+	//save behind. Contents that failed to be written are kept until the file is written again.
+	class CMcFileWriter
+	{
+	public:
+		CMcFileWriter();
+		virtual ~CMcFileWriter();
+
+		void Write(const fs::path&, std::vector<uint8>);
+		bool GetPendingContents(const fs::path&, std::vector<uint8>&) const;
+		//Returns false if some files couldn't be written
+		bool Sync();
+		bool HasFailed(const fs::path&) const;
+
+		static bool IsTemporaryFile(const fs::path&);
+
+	private:
+		typedef std::map<fs::path, std::vector<uint8>> PendingFileMap;
+
+		void ThreadProc();
+		static void Persist(const fs::path&, const std::vector<uint8>&);
+
+		std::thread m_thread;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_pendingCondition;
+		std::condition_variable m_idleCondition;
+		PendingFileMap m_pendingFiles;
+		PendingFileMap m_failedFiles;
+		fs::path m_writingPath;
+		std::vector<uint8> m_writingContents;
+		bool m_writing = false;
+		bool m_terminate = false;
+	};
+}
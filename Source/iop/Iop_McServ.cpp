@@ -66,6 +66,18 @@ CMcServ::CMcServ(CIopBios& bios, CSifMan& sifMan, CSifCmd& sifCmd, CSysmem& sysM
 	SetModuleVersion(1000);
 }
 
+CMcServ::~CMcServ()
+{
+	//Make sure data written to files that are still opened isn't lost
+	for(auto& file : m_files)
+	{
+		if(!file.IsEmpty() && file.IsDirty())
+		{
+			CommitFile(file);
+		}
+	}
+}
+
 void CMcServ::SetModuleVersion(unsigned int)
 {
 	//We don't really care about the version here.
@@ -185,6 +197,13 @@ void CMcServ::CountTicks(uint32 ticks, CSifMan* sifMan)
 	}
 }
 
+uint32 CMcServ::GetTicksUntilNextEvent() const
+{
+	auto moduleData = reinterpret_cast<const MODULEDATA*>(m_ram + m_moduleDataAddr);
+	if(moduleData->pendingCommand == CMD_ID_NONE) return ~0U;
+	return moduleData->pendingCommandDelay;
+}
+
 void CMcServ::Invoke(CMIPS& context, unsigned int functionId)
 {
 	switch(functionId)
@@ -415,6 +434,12 @@ void CMcServ::GetInfo(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize
 	bool isKnownCard = m_knownMemoryCards[port];
 	m_knownMemoryCards[port] = true;
 
+	if(!isKnownCard)
+	{
+		//Card contents might have been changed outside of mcserv
+		m_pathFinder.Invalidate();
+	}
+
 	//Return values
 	//  0 if same card as previous call
 	//  -1 if new formatted card
@@ -465,6 +490,7 @@ void CMcServ::Open(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, u
 			else
 			{
 				fs::create_directory(filePath);
+				m_pathFinder.Invalidate();
 				result = 0;
 			}
 		}
@@ -476,44 +502,71 @@ void CMcServ::Open(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, u
 	}
 	else
 	{
-		if(cmd->flags & OPEN_FLAG_CREAT)
+		uint32 handle = GenerateHandle();
+		if(handle == -1)
+		{
+			//Exhausted all file handles
+			ret[0] = RET_NO_ENTRY;
+			return;
+		}
+
+		try
 		{
-			if(!fs::exists(filePath))
+			if(auto openedFile = FindOpenedFile(filePath))
 			{
-				//Create file if it doesn't exist
-				try
+				//Share contents with the other handle, both need to see each other's writes
+				auto& file = m_files[handle];
+				file.OpenShared(*openedFile);
+				if(cmd->flags & OPEN_FLAG_TRUNC)
 				{
-					Framework::CreateOutputStdStream(filePath.native());
+					file.Truncate();
+					CommitFile(file);
 				}
-				catch(...)
+				ret[0] = handle;
+				return;
+			}
+
+			//Contents that haven't been persisted yet are more recent than what's on disk
+			std::vector<uint8> contents;
+			bool exists = m_fileWriter.GetPendingContents(filePath, contents);
+			if(!exists && fs::exists(filePath))
+			{
+				if(fs::is_directory(filePath))
 				{
-					//Might fail in some conditions (ex.: if file is to be created in a directory that doesn't exist).
 					ret[0] = RET_NO_ENTRY;
 					return;
 				}
+				auto stream = Framework::CreateInputStdStream(filePath.native());
+				contents.resize(stream.GetLength());
+				stream.Read(contents.data(), contents.size());
+				exists = true;
 			}
-		}
 
-		if(cmd->flags & OPEN_FLAG_TRUNC)
-		{
-			if(fs::exists(filePath))
+			bool created = false;
+			if(!exists)
+			{
+				//Creating a file in a directory that doesn't exist fails
+				if(!(cmd->flags & OPEN_FLAG_CREAT) || !fs::is_directory(filePath.parent_path()))
+				{
+					ret[0] = RET_NO_ENTRY;
+					return;
+				}
+				created = true;
+			}
+			else if(cmd->flags & OPEN_FLAG_TRUNC)
 			{
-				//Create file (discard contents) if it exists
-				Framework::CreateOutputStdStream(filePath.native());
+				//Discard contents if file exists
+				contents.clear();
+				created = true;
 			}
-		}
 
-		//At this point, we assume that the file has been created or truncated
-		try
-		{
-			auto file = Framework::CreateUpdateExistingStdStream(filePath.native());
-			uint32 handle = GenerateHandle();
-			if(handle == -1)
+			auto& file = m_files[handle];
+			file.Open(filePath, std::move(contents));
+			if(created)
 			{
-				//Exhausted all file handles
-				throw std::exception();
+				//Make sure the file shows up on the card even if nothing gets written to it
+				CommitFile(file);
 			}
-			m_files[handle] = std::move(file);
 			ret[0] = handle;
 		}
 		catch(...)
@@ -539,9 +592,19 @@ void CMcServ::Close(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 		return;
 	}
 
+	//Contents are persisted asynchronously, only a previous failure can be reported here
+	bool writeFailed = false;
+	if(file->IsDirty())
+	{
+		CommitFile(*file);
+	}
+	else
+	{
+		writeFailed = m_fileWriter.HasFailed(file->GetPath());
+	}
 	file->Clear();
 
-	ret[0] = 0;
+	ret[0] = writeFailed ? RET_PERMISSION_DENIED : 0;
 }
 
 void CMcServ::Seek(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, uint8* ram)
@@ -612,10 +675,7 @@ void CMcServ::Read(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, u
 	}
 	else
 	{
-		ret[0] = static_cast<uint32>(file->Read(dst, cmd->size));
-
-		//Sync pointer for games that write after read without seeking or flushing
-		file->Seek(file->Tell(), Framework::STREAM_SEEK_SET);
+		ret[0] = file->Read(dst, cmd->size);
 	}
 }
 
@@ -644,11 +704,8 @@ void CMcServ::Write(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 		result += cmd->origin;
 	}
 
-	result += static_cast<uint32>(file->Write(dst, cmd->size));
+	result += file->Write(dst, cmd->size);
 	ret[0] = result;
-
-	//Force flushing for games that read after write without seeking or flushing
-	file->Flush();
 }
 
 void CMcServ::Flush(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, uint8* ram)
@@ -665,9 +722,15 @@ void CMcServ::Flush(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 		return;
 	}
 
-	file->Flush();
+	if(file->IsDirty())
+	{
+		CommitFile(*file);
+	}
+
+	//Game expects its data to be on the card after this
+	bool writeFailed = !m_fileWriter.Sync() && m_fileWriter.HasFailed(file->GetPath());
 
-	ret[0] = 0;
+	ret[0] = writeFailed ? RET_PERMISSION_DENIED : 0;
 }
 
 void CMcServ::ChDir(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize, uint8* ram)
@@ -773,8 +836,6 @@ void CMcServ::GetDir(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 	{
 		if(cmd->flags == 0)
 		{
-			m_pathFinder.Reset();
-
 			auto mcPath = CAppConfig::GetInstance().GetPreferencePath(m_mcPathPreference[cmd->port]);
 			if(cmd->name[0] != SEPARATOR_CHAR)
 			{
@@ -799,6 +860,9 @@ void CMcServ::GetDir(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 			}
 
 			assert(*mcPath.string().rbegin() != '/');
+
+			//Listing needs to reflect files that are still being written
+			SyncFileWriter();
 			m_pathFinder.Search(mcPath, cmd->name);
 		}
 
@@ -837,6 +901,7 @@ void CMcServ::SetFileInfo(uint32* args, uint32 argsSize, uint32* ret, uint32 ret
 		{
 			try
 			{
+				SyncFileWriter();
 				if(!fs::exists(filePath1))
 				{
 					ret[0] = RET_NO_ENTRY;
@@ -844,6 +909,7 @@ void CMcServ::SetFileInfo(uint32* args, uint32 argsSize, uint32* ret, uint32 ret
 				}
 
 				fs::rename(filePath1, filePath2);
+				m_pathFinder.Invalidate();
 			}
 			catch(...)
 			{
@@ -878,9 +944,11 @@ void CMcServ::Delete(uint32* args, uint32 argsSize, uint32* ret, uint32 retSize,
 	try
 	{
 		auto filePath = GetHostFilePath(cmd->port, cmd->slot, cmd->name);
+		SyncFileWriter();
 		if(fs::exists(filePath))
 		{
 			fs::remove(filePath);
+			m_pathFinder.Invalidate();
 			ret[0] = 0;
 		}
 		else
@@ -1006,7 +1074,7 @@ void CMcServ::WriteFast(uint32* args, uint32 argsSize, uint32* ret, uint32 retSi
 	const void* dst = &ram[cmd->bufferAddress];
 	uint32 result = 0;
 
-	result += static_cast<uint32>(file->Write(dst, cmd->size));
+	result += file->Write(dst, cmd->size);
 	ret[0] = result;
 }
 
@@ -1074,6 +1142,7 @@ void CMcServ::ProceedReadFast(CMIPS& context)
 	if(auto sifManPs2 = dynamic_cast<CSifManPs2*>(&m_sifMan))
 	{
 		auto eeRam = sifManPs2->GetEeRam();
+		auto writeLock = sifManPs2->PrepareEeRamWrite(moduleData->readFastBufferAddress, readSize);
 		memcpy(eeRam + moduleData->readFastBufferAddress, cluster, readSize);
 	}
 
@@ -1106,7 +1175,7 @@ uint32 CMcServ::GenerateHandle()
 	return -1;
 }
 
-Framework::CStdStream* CMcServ::GetFileFromHandle(uint32 handle)
+CMcServ::CBufferedFile* CMcServ::GetFileFromHandle(uint32 handle)
 {
 	assert(handle < MAX_FILES);
 	if(handle >= MAX_FILES)
@@ -1121,6 +1190,33 @@ Framework::CStdStream* CMcServ::GetFileFromHandle(uint32 handle)
 	return &file;
 }
 
+CMcServ::CBufferedFile* CMcServ::FindOpenedFile(const fs::path& path)
+{
+	for(auto& file : m_files)
+	{
+		if(!file.IsEmpty() && (file.GetPath() == path))
+		{
+			return &file;
+		}
+	}
+	return nullptr;
+}
+
+void CMcServ::SyncFileWriter()
+{
+	if(!m_fileWriter.Sync())
+	{
+		CLog::GetInstance().Warn(LOG_NAME, "Some memory card files couldn't be written to disk.\r\n");
+	}
+}
+
+void CMcServ::CommitFile(CBufferedFile& file)
+{
+	m_fileWriter.Write(file.GetPath(), file.GetContents());
+	file.ClearDirty();
+	m_pathFinder.Invalidate();
+}
+
 fs::path CMcServ::GetHostFilePath(unsigned int port, unsigned int slot, const char* path) const
 {
 	auto mcPath = CAppConfig::GetInstance().GetPreferencePath(m_mcPathPreference[port]);
@@ -1157,6 +1253,8 @@ void CMcServ::LoadState(Framework::CZipArchiveReader& archive)
 		Framework::Xml::GetAttributeIntValue(fileNode, STATE_MEMCARDS_CARDNODE_PORTATTRIBUTE, &i);
 		Framework::Xml::GetAttributeBoolValue(fileNode, STATE_MEMCARDS_CARDNODE_KNOWNATTRIBUTE, &m_knownMemoryCards[i]);
 	}
+
+	m_pathFinder.Invalidate();
 }
 
 void CMcServ::SaveState(Framework::CZipArchiveWriter& archive) const
@@ -1175,6 +1273,128 @@ void CMcServ::SaveState(Framework::CZipArchiveWriter& archive) const
 	archive.InsertFile(std::move(stateFile));
 }
 
+/////////////////////////////////////////////
+//CBufferedFile Implementation
+/////////////////////////////////////////////
+
+void CMcServ::CBufferedFile::Open(const fs::path& path, std::vector<uint8> contents)
+{
+	m_path = path;
+	m_contents = std::make_shared<CONTENTS>();
+	m_contents->data = std::move(contents);
+	m_position = 0;
+}
+
+void CMcServ::CBufferedFile::OpenShared(const CBufferedFile& file)
+{
+	assert(!file.IsEmpty());
+	m_path = file.m_path;
+	m_contents = file.m_contents;
+	m_position = 0;
+}
+
+void CMcServ::CBufferedFile::Truncate()
+{
+	assert(!IsEmpty());
+	m_contents->data.clear();
+	m_contents->dirty = true;
+	m_position = 0;
+}
+
+void CMcServ::CBufferedFile::Clear()
+{
+	m_path.clear();
+	m_contents.reset();
+	m_position = 0;
+}
+
+bool CMcServ::CBufferedFile::IsEmpty() const
+{
+	return !m_contents;
+}
+
+const fs::path& CMcServ::CBufferedFile::GetPath() const
+{
+	return m_path;
+}
+
+const std::vector<uint8>& CMcServ::CBufferedFile::GetContents() const
+{
+	assert(!IsEmpty());
+	return m_contents->data;
+}
+
+bool CMcServ::CBufferedFile::IsDirty() const
+{
+	return m_contents && m_contents->dirty;
+}
+
+void CMcServ::CBufferedFile::ClearDirty()
+{
+	assert(!IsEmpty());
+	m_contents->dirty = false;
+}
+
+uint32 CMcServ::CBufferedFile::Read(void* buffer, uint32 size)
+{
+	uint32 readSize = static_cast<uint32>(std::min<uint64>(size, GetRemainingLength()));
+	if(readSize != 0)
+	{
+		memcpy(buffer, m_contents->data.data() + m_position, readSize);
+	}
+	m_position += readSize;
+	return readSize;
+}
+
+uint32 CMcServ::CBufferedFile::Write(const void* buffer, uint32 size)
+{
+	if(size == 0) return 0;
+	//Writing past the end grows the file, gap is filled with zeroes
+	auto& data = m_contents->data;
+	uint64 endPosition = m_position + size;
+	if(endPosition > data.size())
+	{
+		data.resize(endPosition);
+	}
+	memcpy(data.data() + m_position, buffer, size);
+	m_position = endPosition;
+	m_contents->dirty = true;
+	return size;
+}
+
+void CMcServ::CBufferedFile::Seek(int64 offset, Framework::STREAM_SEEK_DIRECTION origin)
+{
+	int64 base = 0;
+	switch(origin)
+	{
+	case Framework::STREAM_SEEK_SET:
+		base = 0;
+		break;
+	case Framework::STREAM_SEEK_CUR:
+		base = m_position;
+		break;
+	case Framework::STREAM_SEEK_END:
+		base = m_contents->data.size();
+		break;
+	}
+	m_position = std::max<int64>(base + offset, 0);
+}
+
+uint64 CMcServ::CBufferedFile::Tell() const
+{
+	return m_position;
+}
+
+bool CMcServ::CBufferedFile::IsEOF() const
+{
+	return m_position >= m_contents->data.size();
+}
+
+uint64 CMcServ::CBufferedFile::GetRemainingLength() const
+{
+	return IsEOF() ? 0 : (m_contents->data.size() - m_position);
+}
+
 /////////////////////////////////////////////
 //CPathFinder Implementation
 /////////////////////////////////////////////
@@ -1188,14 +1408,31 @@ CMcServ::CPathFinder::~CPathFinder()
 {
 }
 
-void CMcServ::CPathFinder::Reset()
+void CMcServ::CPathFinder::Invalidate()
 {
-	m_entries.clear();
-	m_index = 0;
+	//Entries of a search in progress are kept, only future searches are affected
+	m_listingCache.clear();
 }
 
 void CMcServ::CPathFinder::Search(const fs::path& basePath, const char* filter)
 {
+	m_index = 0;
+
+	auto listingKey = ListingKey(basePath, filter);
+	auto listingIterator = m_listingCache.find(listingKey);
+	if(listingIterator != std::end(m_listingCache))
+	{
+		if(IsListingUpToDate(listingIterator->second))
+		{
+			//Nothing changed on the card since the last time this was searched
+			m_entries = listingIterator->second.entries;
+			return;
+		}
+		m_listingCache.erase(listingIterator);
+	}
+
+	m_entries.clear();
+	m_directoryStates.clear();
 	m_basePath = basePath;
 
 	std::string filterPathString = filter;
@@ -1255,6 +1492,11 @@ void CMcServ::CPathFinder::Search(const fs::path& basePath, const char* filter)
 	}
 
 	SearchRecurse(m_basePath);
+
+	LISTING listing;
+	listing.entries = m_entries;
+	listing.directoryStates = std::move(m_directoryStates);
+	m_listingCache.emplace(std::move(listingKey), std::move(listing));
 }
 
 unsigned int CMcServ::CPathFinder::Read(ENTRY* entry, unsigned int size)
@@ -1278,10 +1520,18 @@ void CMcServ::CPathFinder::SearchRecurse(const fs::path& path)
 	bool found = false;
 	fs::directory_iterator endIterator;
 
+	AddDirectoryState(path);
+
 	for(fs::directory_iterator elementIterator(path);
 	    elementIterator != endIterator; elementIterator++)
 	{
 		fs::path relativePath(*elementIterator);
+		if(CMcFileWriter::IsTemporaryFile(relativePath))
+		{
+			//Leftover from a write that was interrupted
+			continue;
+		}
+
 		std::string relativePathString(relativePath.generic_string());
 
 		//"Extract" a more appropriate relative path from the memory card point of view
@@ -1302,6 +1552,7 @@ void CMcServ::CPathFinder::SearchRecurse(const fs::path& path)
 			{
 				entry.size = CountEntries(*elementIterator);
 				entry.attributes = MC_FILE_ATTR_FOLDER;
+				AddDirectoryState(*elementIterator);
 			}
 			else
 			{
@@ -1346,3 +1597,60 @@ uint32 CMcServ::CPathFinder::CountEntries(const fs::path& path)
 	}
 	return entryCount;
 }
+
+void CMcServ::CPathFinder::AddDirectoryState(const fs::path& path)
+{
+	DIRECTORY_STATE state;
+	if(!GetDirectoryState(path, state)) return;
+	m_directoryStates.push_back(std::move(state));
+}
+
+bool CMcServ::CPathFinder::GetDirectoryState(const fs::path& path, DIRECTORY_STATE& state)
+{
+	std::error_code errorCode;
+	state.path = path;
+	state.lastWriteTime = fs::last_write_time(path, errorCode);
+	if(errorCode) return false;
+
+	//Entries can come in any order, combine their hashes in a way that doesn't depend on it
+	state.entryCount = 0;
+	state.contentsHash = 0;
+	for(fs::directory_iterator elementIterator(path, errorCode), endIterator;
+	    !errorCode && (elementIterator != endIterator); elementIterator.increment(errorCode))
+	{
+		const auto& element = *elementIterator;
+		size_t elementHash = std::hash<std::string>()(element.path().filename().string());
+		std::error_code sizeErrorCode;
+		if(element.is_regular_file(sizeErrorCode))
+		{
+			elementHash ^= std::hash<uintmax_t>()(element.file_size(sizeErrorCode)) * 31;
+		}
+		state.contentsHash += elementHash;
+		state.entryCount++;
+	}
+	return !errorCode;
+}
+
+bool CMcServ::CPathFinder::IsListingUpToDate(const LISTING& listing)
+{
+	for(const auto& directoryState : listing.directoryStates)
+	{
+		DIRECTORY_STATE currentState;
+		if(!GetDirectoryState(directoryState.path, currentState) || (currentState != directoryState))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool CMcServ::CPathFinder::DIRECTORY_STATE::operator==(const DIRECTORY_STATE& rhs) const
+{
+	return (path == rhs.path) && (lastWriteTime == rhs.lastWriteTime) &&
+	       (entryCount == rhs.entryCount) && (contentsHash == rhs.contentsHash);
+}
+
+bool CMcServ::CPathFinder::DIRECTORY_STATE::operator!=(const DIRECTORY_STATE& rhs) const
+{
+	return !(*this == rhs);
+}
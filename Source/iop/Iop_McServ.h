@@ -2,11 +2,13 @@
 
 #include <string>
 #include <map>
+#include <memory>
 #include <regex>
 #include "filesystem_def.h"
-#include "StdStream.h"
+#include "Stream.h"
 #include "Iop_Module.h"
 #include "Iop_SifMan.h"
+#include "Iop_McFileWriter.h"
 
 class CMIPSAssembler;
 class CIopBios;
@@ -123,7 +125,7 @@ namespace Iop
 		};
 
 		CMcServ(CIopBios&, CSifMan&, CSifCmd&, CSysmem&, uint8*);
-		virtual ~CMcServ() = default;
+		virtual ~CMcServ();
 
 		void SetModuleVersion(unsigned int);
 
@@ -141,6 +143,7 @@ namespace Iop
 		void SaveState(Framework::CZipArchiveWriter&) const override;
 
 		void CountTicks(uint32, CSifMan*);
+		uint32 GetTicksUntilNextEvent() const;
 
 	private:
 		struct MODULEDATA
@@ -174,26 +177,90 @@ namespace Iop
 			MAX_SLOTS = 1,
 		};
 
+		//Keeps the whole contents of an opened file in memory. Modified contents
+		//are handed over to the file writer when the file is flushed or closed.
+		//Handles opened on the same file share their contents, but not their position.
+		class CBufferedFile
+		{
+		public:
+			void Open(const fs::path&, std::vector<uint8>);
+			void OpenShared(const CBufferedFile&);
+			void Truncate();
+			void Clear();
+			bool IsEmpty() const;
+
+			const fs::path& GetPath() const;
+			const std::vector<uint8>& GetContents() const;
+			bool IsDirty() const;
+			void ClearDirty();
+
+			uint32 Read(void*, uint32);
+			uint32 Write(const void*, uint32);
+			void Seek(int64, Framework::STREAM_SEEK_DIRECTION);
+			uint64 Tell() const;
+			bool IsEOF() const;
+			uint64 GetRemainingLength() const;
+
+		private:
+			struct CONTENTS
+			{
+				std::vector<uint8> data;
+				bool dirty = false;
+			};
+			typedef std::shared_ptr<CONTENTS> ContentsPtr;
+
+			fs::path m_path;
+			ContentsPtr m_contents;
+			uint64 m_position = 0;
+		};
+
 		class CPathFinder
 		{
 		public:
 			CPathFinder();
 			virtual ~CPathFinder();
 
-			void Reset();
+			void Invalidate();
 			void Search(const fs::path&, const char*);
 			unsigned int Read(ENTRY*, unsigned int);
 
 		private:
 			typedef std::vector<ENTRY> EntryList;
+			typedef std::pair<fs::path, std::string> ListingKey;
+
+			//Modification times can be as coarse as 2 seconds (ie.: FAT), contents are checked too
+			struct DIRECTORY_STATE
+			{
+				fs::path path;
+				fs::file_time_type lastWriteTime;
+				uint32 entryCount = 0;
+				size_t contentsHash = 0;
+
+				bool operator==(const DIRECTORY_STATE&) const;
+				bool operator!=(const DIRECTORY_STATE&) const;
+			};
+			typedef std::vector<DIRECTORY_STATE> DirectoryStateList;
+
+			//Listing stays valid as long as none of the directories it looked at changed
+			struct LISTING
+			{
+				EntryList entries;
+				DirectoryStateList directoryStates;
+			};
+			typedef std::map<ListingKey, LISTING> ListingCache;
 
 			void SearchRecurse(const fs::path&);
 			uint32 CountEntries(const fs::path&);
+			void AddDirectoryState(const fs::path&);
+			static bool GetDirectoryState(const fs::path&, DIRECTORY_STATE&);
+			static bool IsListingUpToDate(const LISTING&);
 
 			EntryList m_entries;
+			DirectoryStateList m_directoryStates;
 			fs::path m_basePath;
 			std::regex m_filterExp;
 			unsigned int m_index;
+			ListingCache m_listingCache;
 		};
 
 		void BuildCustomCode();
@@ -224,7 +291,10 @@ namespace Iop
 		void FinishReadFast(CMIPS&);
 
 		uint32 GenerateHandle();
-		Framework::CStdStream* GetFileFromHandle(uint32);
+		CBufferedFile* GetFileFromHandle(uint32);
+		CBufferedFile* FindOpenedFile(const fs::path&);
+		void CommitFile(CBufferedFile&);
+		void SyncFileWriter();
 		fs::path GetHostFilePath(unsigned int, unsigned int, const char*) const;
 
 		CIopBios& m_bios;
@@ -237,7 +307,8 @@ namespace Iop
 		uint32 m_proceedReadFastAddr = 0;
 		uint32 m_finishReadFastAddr = 0;
 		uint32 m_readFastAddr = 0;
-		Framework::CStdStream m_files[MAX_FILES];
+		CMcFileWriter m_fileWriter;
+		CBufferedFile m_files[MAX_FILES];
 		static const char* m_mcPathPreference[MAX_PORTS];
 		std::string m_currentDirectory[MAX_PORTS];
 		CPathFinder m_pathFinder;
@@ -1,4 +1,5 @@
 #include <assert.h>
+#include <algorithm>
 #include <cstring>
 #include "Iop_RootCounters.h"
 #include "Iop_Intc.h"
@@ -119,50 +120,12 @@ void CRootCounters::Update(unsigned int ticks)
 		auto& counter = m_counter[i];
 		if(i == 2 && counter.mode.en) continue;
 		//Compute count increment
-		uint32 clockRatio = 1;
-		if(i == 0 && counter.mode.clc)
-		{
-			clockRatio = m_pixelClocks;
-		}
-		if(((i == 1) || (i == 3)) && counter.mode.clc)
-		{
-			clockRatio = m_hsyncClocks;
-		}
-		if(i == 2 && (counter.mode.div != COUNTER_SCALE_1))
-		{
-			assert(counter.mode.div == COUNTER_SCALE_8);
-			clockRatio = 8;
-		}
-		if(
-		    ((i == 4) || (i == 5)) &&
-		    (counter.mode.div != COUNTER_SCALE_1))
-		{
-			switch(counter.mode.div)
-			{
-			case COUNTER_SCALE_8:
-				clockRatio = 8;
-				break;
-			case COUNTER_SCALE_16:
-				clockRatio = 16;
-				break;
-			case COUNTER_SCALE_256:
-				clockRatio = 256;
-				break;
-			}
-		}
+		uint32 clockRatio = GetClockRatio(i);
 		uint32 totalTicks = counter.clockRemain + ticks;
 		uint64 countAdd = totalTicks / clockRatio;
 		counter.clockRemain = totalTicks % clockRatio;
 		//Update count
-		uint64 counterMax = 0;
-		if(g_counterSizes[i] == 16)
-		{
-			counterMax = counter.mode.tar ? static_cast<uint16>(counter.target) : 0xFFFF;
-		}
-		else
-		{
-			counterMax = counter.mode.tar ? counter.target : 0xFFFFFFFF;
-		}
+		uint64 counterMax = GetCounterMax(i);
 		uint64 counterTemp = static_cast<uint64>(counter.count) + countAdd;
 		if(counterTemp >= counterMax)
 		{
@@ -183,6 +146,73 @@ void CRootCounters::Update(unsigned int ticks)
 	}
 }
 
+uint32 CRootCounters::GetTicksUntilNextInterrupt() const
+{
+	uint64 result = ~0U;
+	for(unsigned int i = 0; i < MAX_COUNTERS; i++)
+	{
+		const auto& counter = m_counter[i];
+		if(i == 2 && counter.mode.en) continue;
+		if(!(counter.mode.iq1 && counter.mode.iq2)) continue;
+		uint64 counterMax = GetCounterMax(i);
+		uint64 countRemain = (counter.count < counterMax) ? (counterMax - counter.count) : 0;
+		uint64 ticks = countRemain * GetClockRatio(i);
+		ticks -= std::min<uint64>(ticks, counter.clockRemain);
+		result = std::min<uint64>(result, ticks);
+	}
+	return static_cast<uint32>(result);
+}
+
+uint32 CRootCounters::GetClockRatio(unsigned int i) const
+{
+	const auto& counter = m_counter[i];
+	uint32 clockRatio = 1;
+	if(i == 0 && counter.mode.clc)
+	{
+		clockRatio = m_pixelClocks;
+	}
+	if(((i == 1) || (i == 3)) && counter.mode.clc)
+	{
+		clockRatio = m_hsyncClocks;
+	}
+	if(i == 2 && (counter.mode.div != COUNTER_SCALE_1))
+	{
+		assert(counter.mode.div == COUNTER_SCALE_8);
+		clockRatio = 8;
+	}
+	if(
+	    ((i == 4) || (i == 5)) &&
+	    (counter.mode.div != COUNTER_SCALE_1))
+	{
+		switch(counter.mode.div)
+		{
+		case COUNTER_SCALE_8:
+			clockRatio = 8;
+			break;
+		case COUNTER_SCALE_16:
+			clockRatio = 16;
+			break;
+		case COUNTER_SCALE_256:
+			clockRatio = 256;
+			break;
+		}
+	}
+	return clockRatio;
+}
+
+uint64 CRootCounters::GetCounterMax(unsigned int i) const
+{
+	const auto& counter = m_counter[i];
+	if(g_counterSizes[i] == 16)
+	{
+		return counter.mode.tar ? static_cast<uint16>(counter.target) : 0xFFFF;
+	}
+	else
+	{
+		return counter.mode.tar ? counter.target : 0xFFFFFFFF;
+	}
+}
+
 uint32 CRootCounters::ReadRegister(uint32 address)
 {
 #ifdef _DEBUG
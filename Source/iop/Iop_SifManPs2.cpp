@@ -86,6 +86,7 @@ uint32 CSifManPs2::SifSetDma(uint32 structAddr, uint32 count)
 		else
 		{
 			uint8* dst = m_eeRam + dstAddr;
+			auto writeLock = m_sif.PrepareEeRamWrite(dstAddr, dmaReg.size);
 			memcpy(dst, src, dmaReg.size);
 		}
 	}
@@ -97,3 +98,8 @@ uint8* CSifManPs2::GetEeRam() const
 {
 	return m_eeRam;
 }
+
+CSIF::EeRamWriteLock CSifManPs2::PrepareEeRamWrite(uint32 address, uint32 size)
+{
+	return m_sif.PrepareEeRamWrite(address, size);
+}
@@ -25,6 +25,7 @@ namespace Iop
 		uint32 SifSetDma(uint32, uint32) override;
 
 		uint8* GetEeRam() const;
+		CSIF::EeRamWriteLock PrepareEeRamWrite(uint32, uint32);
 
 	private:
 		CSIF& m_sif;
@@ -155,6 +155,8 @@ CSpuBase::CSpuBase(uint8* ram, uint32 ramSize, CSpuSampleCache* sampleCache, CSp
     , m_irqWatcher(irqWatcher)
     , m_reverbEnabled(true)
 {
+	//Sample cache needs a slot for every block of SPU RAM
+	assert(!m_sampleCache || (m_ramSize <= m_sampleCache->GetRamSize()));
 	Reset();
 
 	//Init log table for ADSR
@@ -367,6 +369,11 @@ bool CSpuBase::GetIrqPending() const
 	return m_irqPending;
 }
 
+bool CSpuBase::IsIrqEnabled() const
+{
+	return (m_ctrl & CONTROL_IRQ) != 0;
+}
+
 void CSpuBase::ClearIrqPending()
 {
 	m_irqPending = false;
@@ -1099,39 +1106,68 @@ void CSpuBase::UpdateReverb(int16 reverbSample[2], int16* samples)
 // CSpuSampleCache
 ///////////////////////////////////////////////////////
 
+CSpuSampleCache::CSpuSampleCache(uint32 ramSize)
+    : m_blockCount(ramSize / BLOCK_SIZE)
+{
+	assert(m_blockCount != 0);
+	m_slots.resize(m_blockCount);
+}
+
+uint32 CSpuSampleCache::GetRamSize() const
+{
+	return m_blockCount * BLOCK_SIZE;
+}
+
 const CSpuSampleCache::ITEM* CSpuSampleCache::GetItem(const KEY& key) const
 {
-	auto range = m_cache.equal_range(key.address);
-	for(auto itemIterator = range.first; itemIterator != range.second; itemIterator++)
-	{
-		const auto& item = itemIterator->second;
-		if((item.inS1 == key.s1) && (item.inS2 == key.s2))
-		{
-			return &item;
-		}
-	}
-	return nullptr;
+	assert((key.address % BLOCK_SIZE) == 0);
+	uint32 blockIndex = (key.address / BLOCK_SIZE) % m_blockCount;
+	const auto& slot = m_slots[blockIndex];
+	if(slot.generation != m_generation) return nullptr;
+	if(slot.address != key.address) return nullptr;
+	const auto& item = slot.item;
+	if((item.inS1 != key.s1) || (item.inS2 != key.s2)) return nullptr;
+	return &item;
 }
 
 CSpuSampleCache::ITEM& CSpuSampleCache::RegisterItem(const KEY& key)
 {
-	auto result = m_cache.emplace(std::make_pair(key.address, ITEM()));
-	auto& item = result->second;
-	item.inS1 = key.s1;
-	item.inS2 = key.s2;
-	return item;
+	//Only one decoded version of a block is kept, a block decoded with
+	//different predictor state replaces the previous one
+	assert((key.address % BLOCK_SIZE) == 0);
+	uint32 blockIndex = (key.address / BLOCK_SIZE) % m_blockCount;
+	auto& slot = m_slots[blockIndex];
+	slot.address = key.address;
+	slot.generation = m_generation;
+	slot.item.inS1 = key.s1;
+	slot.item.inS2 = key.s2;
+	return slot.item;
 }
 
 void CSpuSampleCache::Clear()
 {
-	m_cache.clear();
+	m_generation++;
+	if(m_generation == 0)
+	{
+		//Generation wrapped around, make sure old slots can't become valid again
+		for(auto& slot : m_slots)
+		{
+			slot.generation = 0;
+		}
+		m_generation = 1;
+	}
 }
 
 void CSpuSampleCache::ClearRange(uint32 address, uint32 size)
 {
-	auto lowerBound = m_cache.lower_bound(address);
-	auto upperBound = m_cache.upper_bound(address + size);
-	m_cache.erase(lowerBound, upperBound);
+	if(size == 0) return;
+	uint32 firstBlock = address / BLOCK_SIZE;
+	uint32 lastBlock = (address + size - 1) / BLOCK_SIZE;
+	uint32 blockCount = std::min(lastBlock - firstBlock + 1, m_blockCount);
+	for(uint32 i = 0; i < blockCount; i++)
+	{
+		m_slots[(firstBlock + i) % m_blockCount].generation = 0;
+	}
 }
 
 ///////////////////////////////////////////////////////
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <map>
+#include <vector>
 #include "Types.h"
 #include "BasicUnion.h"
 #include "Convertible.h"
@@ -11,10 +11,15 @@ class CRegisterState;
 
 namespace Iop
 {
+	//Direct-mapped cache of decoded ADPCM blocks, one slot per 16-byte block of SPU RAM.
+	//A slot is valid only if its generation matches the cache's, which allows
+	//clearing the whole cache without touching every slot.
 	class CSpuSampleCache
 	{
 	public:
 		static constexpr int BUFFER_SAMPLES = 28;
+		static constexpr uint32 BLOCK_SIZE = 0x10;
+		static constexpr uint32 DEFAULT_RAM_SIZE = 0x200000;
 
 		struct KEY
 		{
@@ -32,13 +37,27 @@ namespace Iop
 			int32 outS2;
 		};
 
+		CSpuSampleCache(uint32 = DEFAULT_RAM_SIZE);
+
+		uint32 GetRamSize() const;
+
 		const ITEM* GetItem(const KEY&) const;
 		ITEM& RegisterItem(const KEY&);
 		void Clear();
 		void ClearRange(uint32 address, uint32 size);
 
 	private:
-		std::multimap<uint32, ITEM> m_cache;
+		struct SLOT
+		{
+			ITEM item;
+			uint32 address = 0;
+			uint32 generation = 0;
+		};
+
+		//Slots with generation 0 are never valid
+		std::vector<SLOT> m_slots;
+		uint32 m_blockCount = 0;
+		uint32 m_generation = 1;
 	};
 
 	class CSpuIrqWatcher
@@ -223,6 +242,7 @@ namespace Iop
 		void SetDestinationSamplingRate(uint32);
 
 		bool GetIrqPending() const;
+		bool IsIrqEnabled() const;
 		void ClearIrqPending();
 
 		uint32 GetIrqAddress() const;
@@ -1,6 +1,6 @@
 #include "Iop_SubSystem.h"
 #include "IopBios.h"
-#include "GenericMipsExecutor.h"
+#include "IopExecutor.h"
 #include "../psx/PsxBios.h"
 #include "../states/MemoryStateFile.h"
 #include "../states/RegisterStateFile.h"
@@ -22,6 +22,8 @@ using namespace PS2;
 #define STATE_TIMING_DMA_UPDATE_TICKS ("dmaUpdateTicks")
 #define STATE_TIMING_SPU_IRQ_UPDATE_TICKS ("spuIrqUpdateTicks")
 
+static_assert(SPU_RAM_SIZE <= CSpuSampleCache::DEFAULT_RAM_SIZE, "SPU sample cache is too small for SPU RAM.");
+
 CSubSystem::CSubSystem(bool ps2Mode)
     : m_cpu(MEMORYMAP_ENDIAN_LSBF, true)
     , m_cpuArch(MIPS_REGSIZE_32)
@@ -50,7 +52,7 @@ CSubSystem::CSubSystem(bool ps2Mode)
 		m_bios = std::make_shared<CPsxBios>(m_cpu, m_ram, PS2::IOP_BASE_RAM_SIZE);
 	}
 
-	m_cpu.m_executor = std::make_unique<CGenericMipsExecutor<BlockLookupOneWay>>(m_cpu, (IOP_RAM_SIZE * 4), BLOCK_CATEGORY_PS2_IOP);
+	m_cpu.m_executor = std::make_unique<CIopExecutor>(m_cpu, (IOP_RAM_SIZE * 4));
 
 	//Read memory map
 	m_cpu.m_pMemoryMap->InsertReadMap((0 * IOP_RAM_SIZE), (0 * IOP_RAM_SIZE) + IOP_RAM_SIZE - 1, m_ram, 0x01);
@@ -206,6 +208,7 @@ void CSubSystem::Reset()
 
 	m_dmaUpdateTicks = 0;
 	m_spuIrqUpdateTicks = 0;
+	m_isIdle = false;
 }
 
 void CSubSystem::SetupPageTable()
@@ -361,25 +364,23 @@ void CSubSystem::CheckPendingInterrupts()
 
 bool CSubSystem::IsCpuIdle()
 {
-	return m_bios->IsIdle();
+	return m_bios->IsIdle() || m_isIdle;
 }
 
 void CSubSystem::CountTicks(int ticks)
 {
-	static const int g_dmaUpdateDelay = 10000;
-	static const int g_spuIrqCheckDelay = 1000;
 	m_counters.Update(ticks);
 	m_speed.CountTicks(ticks);
 	m_bios->CountTicks(ticks);
 	m_dmaUpdateTicks += ticks;
-	if(m_dmaUpdateTicks >= g_dmaUpdateDelay)
+	if(m_dmaUpdateTicks >= DMA_UPDATE_DELAY)
 	{
 		m_dmac.ResumeDma(Iop::CDmac::CHANNEL_SPU0);
 		m_dmac.ResumeDma(Iop::CDmac::CHANNEL_SPU1);
-		m_dmaUpdateTicks -= g_dmaUpdateDelay;
+		m_dmaUpdateTicks %= DMA_UPDATE_DELAY;
 	}
 	m_spuIrqUpdateTicks += ticks;
-	if(m_spuIrqUpdateTicks >= g_spuIrqCheckDelay)
+	if(m_spuIrqUpdateTicks >= SPU_IRQ_CHECK_DELAY)
 	{
 		bool irqPending = false;
 		irqPending |= m_spuCore0.GetIrqPending();
@@ -392,12 +393,31 @@ void CSubSystem::CountTicks(int ticks)
 		{
 			m_intc.ClearLine(CIntc::LINE_SPU2);
 		}
-		m_spuIrqUpdateTicks -= g_spuIrqCheckDelay;
+		m_spuIrqUpdateTicks %= SPU_IRQ_CHECK_DELAY;
+	}
+}
+
+uint32 CSubSystem::GetTicksUntilNextEvent()
+{
+	uint32 result = ~0U;
+	result = std::min<uint32>(result, m_counters.GetTicksUntilNextInterrupt());
+	result = std::min<uint32>(result, m_bios->GetTicksUntilNextEvent());
+	//Periodic checks only matter if SPU DMA or IRQs are in use
+	if(m_dmac.IsDmaActive(Iop::CDmac::CHANNEL_SPU0) || m_dmac.IsDmaActive(Iop::CDmac::CHANNEL_SPU1))
+	{
+		result = std::min<uint32>(result, std::max<int>(DMA_UPDATE_DELAY - m_dmaUpdateTicks, 0));
 	}
+	if(m_spuCore0.IsIrqEnabled() || m_spuCore1.IsIrqEnabled() ||
+	   m_spuCore0.GetIrqPending() || m_spuCore1.GetIrqPending())
+	{
+		result = std::min<uint32>(result, std::max<int>(SPU_IRQ_CHECK_DELAY - m_spuIrqUpdateTicks, 0));
+	}
+	return result;
 }
 
 int CSubSystem::ExecuteCpu(int quota)
 {
+	m_isIdle = false;
 	int executed = 0;
 	CheckPendingInterrupts();
 	if(!m_cpu.m_State.nHasException)
@@ -420,6 +440,12 @@ int CSubSystem::ExecuteCpu(int quota)
 			m_cpu.m_State.nHasException = MIPS_EXCEPTION_NONE;
 		}
 		break;
+		case MIPS_EXCEPTION_IDLE:
+		{
+			m_isIdle = true;
+			m_cpu.m_State.nHasException = MIPS_EXCEPTION_NONE;
+		}
+		break;
 		}
 		assert(m_cpu.m_State.nHasException == MIPS_EXCEPTION_NONE);
 	}
@@ -29,6 +29,7 @@ namespace Iop
 		int ExecuteCpu(int);
 		bool IsCpuIdle();
 		void CountTicks(int);
+		uint32 GetTicksUntilNextEvent();
 
 		void NotifyVBlankStart();
 		void NotifyVBlankEnd();
@@ -75,7 +76,14 @@ namespace Iop
 
 		void CheckPendingInterrupts();
 
+		enum
+		{
+			DMA_UPDATE_DELAY = 10000,
+			SPU_IRQ_CHECK_DELAY = 1000,
+		};
+
 		int m_dmaUpdateTicks = 0;
 		int m_spuIrqUpdateTicks = 0;
+		bool m_isIdle = false;
 	};
 }
@@ -3,14 +3,20 @@
 #include <cstring>
 #include "HardDiskDevice.h"
 #include "hdd/ApaReader.h"
+#include "BlockCacheStream.h"
 #include "StringUtils.h"
 #include "MemStream.h"
 
 using namespace Iop;
 using namespace Iop::Ioman;
 
+//PFS inodes, directory blocks and small file reads tend to hit the same areas of the image
+#define IMAGE_CACHE_BLOCK_SIZE (0x4000)
+#define IMAGE_CACHE_MAX_BLOCKS (1024)
+#define IMAGE_CACHE_READAHEAD_BLOCKS (4)
+
 CHardDiskDumpDevice::CHardDiskDumpDevice(std::unique_ptr<Framework::CStream> stream)
-    : m_stream(std::move(stream))
+    : m_stream(std::make_unique<CBlockCacheStream>(std::move(stream), IMAGE_CACHE_BLOCK_SIZE, IMAGE_CACHE_MAX_BLOCKS, IMAGE_CACHE_READAHEAD_BLOCKS))
 {
 }
 
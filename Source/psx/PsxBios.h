@@ -37,6 +37,7 @@ public:
 	void HandleInterrupt() override;
 	void HandleException() override;
 	void CountTicks(uint32) override;
+	uint32 GetTicksUntilNextEvent() override;
 
 	void LoadExe(const uint8*);
 
@@ -103,20 +103,18 @@ void CMcDumpReader::ReadCluster(uint32 clusterIndex, void* buffer)
 
 void CMcDumpReader::ReadClusterCached(uint32 clusterIndex, void* buffer)
 {
-	static const uint32 clusterSize = m_header.pagesPerCluster * m_header.pageSize;
-	auto clusterIterator = m_clusterCache.find(clusterIndex);
-	if(clusterIterator == std::end(m_clusterCache))
+	uint32 clusterSize = m_header.pagesPerCluster * m_header.pageSize;
+	auto cluster = m_clusterCache.Find(clusterIndex);
+	if(!cluster)
 	{
-		Cluster cluster;
-		cluster.resize(clusterSize);
-		ReadCluster(clusterIndex, cluster.data());
-		auto result = m_clusterCache.emplace(std::make_pair(clusterIndex, std::move(cluster)));
-		clusterIterator = result.first;
+		Cluster newCluster;
+		newCluster.resize(clusterSize);
+		ReadCluster(clusterIndex, newCluster.data());
+		cluster = &m_clusterCache.Insert(clusterIndex, std::move(newCluster));
 	}
 
-	const auto& cluster = clusterIterator->second;
-	assert(cluster.size() == clusterSize);
-	memcpy(buffer, cluster.data(), cluster.size());
+	assert(cluster->size() == clusterSize);
+	memcpy(buffer, cluster->data(), cluster->size());
 }
 
 CMcDumpReader::CFatReader::CFatReader(CMcDumpReader& parent, uint32 cluster)
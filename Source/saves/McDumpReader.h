@@ -1,8 +1,8 @@
 #pragma once
 
 #include <vector>
-#include <map>
 #include "Stream.h"
+#include "LruCache.h"
 
 class CMcDumpReader
 {
@@ -63,8 +63,13 @@ public:
 	std::vector<uint8> ReadFile(uint32, uint32);
 
 private:
+	enum
+	{
+		MAX_CACHED_CLUSTERS = 64,
+	};
+
 	typedef std::vector<uint8> Cluster;
-	typedef std::map<uint32, Cluster> ClusterMap;
+	typedef CLruCache<uint32, Cluster> ClusterCache;
 
 	void ReadCluster(uint32, void*);
 	void ReadClusterCached(uint32, void*);
@@ -97,5 +102,5 @@ private:
 	Framework::CStream& m_stream;
 	HEADER m_header = {};
 	uint32 m_rawPageSize = 0;
-	ClusterMap m_clusterCache;
+	ClusterCache m_clusterCache = ClusterCache(MAX_CACHED_CLUSTERS);
 };
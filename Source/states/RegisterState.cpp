@@ -76,6 +76,11 @@ void CRegisterState::SetRegister128(const char* name, uint128 value)
 	m_registers[name] = Register(4, value);
 }
 
+bool CRegisterState::HasRegister(const char* name) const
+{
+	return m_registers.find(name) != m_registers.end();
+}
+
 uint32 CRegisterState::GetRegister32(const char* name) const
 {
 	auto registerIterator(m_registers.find(name));
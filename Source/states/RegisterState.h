@@ -19,6 +19,8 @@ public:
 	uint64 GetRegister64(const char*) const;
 	uint128 GetRegister128(const char*) const;
 
+	bool HasRegister(const char*) const;
+
 private:
 	typedef std::pair<uint8, uint128> Register;
 	typedef std::map<std::string, Register> RegisterList;
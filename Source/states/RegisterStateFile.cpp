@@ -51,6 +51,11 @@ void CRegisterStateFile::SetRegister128(const char* name, uint128 value)
 	m_registers.SetRegister128(name, value);
 }
 
+bool CRegisterStateFile::HasRegister(const char* name) const
+{
+	return m_registers.HasRegister(name);
+}
+
 uint32 CRegisterStateFile::GetRegister32(const char* name) const
 {
 	return m_registers.GetRegister32(name);
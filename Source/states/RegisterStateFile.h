@@ -18,6 +18,8 @@ public:
 	uint64 GetRegister64(const char*) const;
 	uint128 GetRegister128(const char*) const;
 
+	bool HasRegister(const char*) const;
+
 	void Read(Framework::CStream&);
 	void Write(Framework::CStream&) override;
 
@@ -16,7 +16,7 @@ CVu1Vm::CVu1Vm()
 {
 	//Vector Unit 1 context setup
 	{
-		m_vu1.m_executor = std::make_unique<CVuExecutor>(m_vu1, PS2::MICROMEM1SIZE);
+		m_vu1.m_executor = std::make_unique<CVuExecutor>(m_vu1, PS2::MICROMEM1SIZE, true);
 
 		m_vu1.m_pMemoryMap->InsertReadMap(0x00000000, 0x00003FFF, m_vuMem1, 0x00);
 		m_vu1.m_pMemoryMap->InsertReadMap(
@@ -22,6 +22,15 @@ static const char* g_bootablesTableCreateStatement =
     "    overview TEXT DEFAULT ''"
     ")";
 
+//Remembers files that were already inspected during a scan, whether they turned out to be bootable or not
+static const char* g_scannedFilesTableCreateStatement =
+    "CREATE TABLE IF NOT EXISTS scannedFiles"
+    "("
+    "    path TEXT PRIMARY KEY,"
+    "    fileSize INTEGER DEFAULT 0,"
+    "    lastWriteTime INTEGER DEFAULT 0"
+    ")";
+
 CClient::CClient()
 {
 	m_dbPath = CAppConfig::GetInstance().GetBasePath() / g_dbFileName;
@@ -42,6 +51,11 @@ CClient::CClient()
 		statement.StepNoResult();
 	}
 
+	{
+		Framework::CSqliteStatement statement(m_db, g_scannedFilesTableCreateStatement);
+		statement.StepNoResult();
+	}
+
 	{
 		auto path = Framework::PathUtils::GetAppResourcesPath() / "states.db";
 		std::error_code errorCode;
@@ -111,9 +125,18 @@ void CClient::RegisterBootable(const fs::path& path, const char* title, const ch
 
 void CClient::UnregisterBootable(const fs::path& path)
 {
-	Framework::CSqliteStatement statement(m_db, "DELETE FROM bootables WHERE path = ?");
-	statement.BindText(1, Framework::PathUtils::GetNativeStringFromPath(path).c_str());
-	statement.StepNoResult();
+	auto nativePath = Framework::PathUtils::GetNativeStringFromPath(path);
+	{
+		Framework::CSqliteStatement statement(m_db, "DELETE FROM bootables WHERE path = ?");
+		statement.BindText(1, nativePath.c_str());
+		statement.StepNoResult();
+	}
+	//Forget about the file too, it needs to be inspected again if it gets added back
+	{
+		Framework::CSqliteStatement statement(m_db, "DELETE FROM scannedFiles WHERE path = ?");
+		statement.BindText(1, nativePath.c_str());
+		statement.StepNoResult();
+	}
 }
 
 void CClient::SetDiscId(const fs::path& path, const char* discId)
@@ -156,6 +179,68 @@ void CClient::SetOverview(const fs::path& path, const char* overview)
 	statement.StepNoResult();
 }
 
+bool CClient::IsScannedFileUnchanged(const fs::path& path, uint64 fileSize, time_t lastWriteTime)
+{
+	Framework::CSqliteStatement statement(m_db, "SELECT * FROM scannedFiles WHERE path = ? AND fileSize = ? AND lastWriteTime = ?");
+	statement.BindText(1, Framework::PathUtils::GetNativeStringFromPath(path).c_str());
+	statement.BindInteger(2, fileSize);
+	statement.BindInteger(3, lastWriteTime);
+	return statement.Step();
+}
+
+void CClient::SetScannedFile(const fs::path& path, uint64 fileSize, time_t lastWriteTime)
+{
+	Framework::CSqliteStatement statement(m_db, "INSERT OR REPLACE INTO scannedFiles (path, fileSize, lastWriteTime) VALUES (?,?,?)");
+	statement.BindText(1, Framework::PathUtils::GetNativeStringFromPath(path).c_str());
+	statement.BindInteger(2, fileSize);
+	statement.BindInteger(3, lastWriteTime);
+	statement.StepNoResult();
+}
+
+void CClient::BeginTransaction()
+{
+	Framework::CSqliteStatement statement(m_db, "BEGIN TRANSACTION");
+	statement.StepNoResult();
+}
+
+void CClient::CommitTransaction()
+{
+	Framework::CSqliteStatement statement(m_db, "COMMIT");
+	statement.StepNoResult();
+}
+
+void CClient::RollbackTransaction()
+{
+	Framework::CSqliteStatement statement(m_db, "ROLLBACK");
+	statement.StepNoResult();
+}
+
+CTransaction::CTransaction(CClient& client)
+    : m_client(client)
+{
+	m_client.BeginTransaction();
+}
+
+CTransaction::~CTransaction()
+{
+	if(m_committed) return;
+	try
+	{
+		m_client.RollbackTransaction();
+	}
+	catch(...)
+	{
+		//Can't do much about it, the transaction is gone anyways
+	}
+}
+
+void CTransaction::Commit()
+{
+	assert(!m_committed);
+	m_client.CommitTransaction();
+	m_committed = true;
+}
+
 BootableStateList CClient::GetGameStates(std::string discId)
 {
 	BootableStateList states;
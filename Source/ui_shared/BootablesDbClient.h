@@ -57,6 +57,13 @@ namespace BootablesDb
 		void SetLastBootedTime(const fs::path&, time_t);
 		void SetOverview(const fs::path& path, const char* overview);
 
+		bool IsScannedFileUnchanged(const fs::path&, uint64, time_t);
+		void SetScannedFile(const fs::path&, uint64, time_t);
+
+		void BeginTransaction();
+		void CommitTransaction();
+		void RollbackTransaction();
+
 	private:
 		Bootable ReadBootable(Framework::CSqliteStatement&);
 		BootableStateList GetGameStates(std::string);
@@ -67,4 +74,21 @@ namespace BootablesDb
 		Framework::CSqliteDb m_db;
 		bool m_attachedState = false;
 	};
+
+	//Rolls back the transaction if it wasn't committed before going out of scope
+	class CTransaction
+	{
+	public:
+		CTransaction(CClient&);
+		~CTransaction();
+
+		CTransaction(const CTransaction&) = delete;
+		CTransaction& operator=(const CTransaction&) = delete;
+
+		void Commit();
+
+	private:
+		CClient& m_client;
+		bool m_committed = false;
+	};
 };
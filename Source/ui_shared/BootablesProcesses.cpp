@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include "AppConfig.h"
 #include "BootablesProcesses.h"
 #include "BootablesDbClient.h"
@@ -8,6 +10,7 @@
 #include "StringUtils.h"
 #include "string_format.h"
 #include "StdStreamUtils.h"
+#include "FilesystemUtils.h"
 #include "http/HttpClientFactory.h"
 #ifdef __ANDROID__
 #include "android/ContentUtils.h"
@@ -21,6 +24,20 @@
 
 //#define SCAN_LOG
 
+//Number of files inspected before results are committed to the database
+#define SCAN_BATCH_SIZE 256
+#define SCAN_MAX_WORKERS 8
+
+struct SCAN_ITEM
+{
+	fs::path path;
+	uint64 fileSize = 0;
+	time_t lastWriteTime = 0;
+	bool hasFileInfo = false;
+	bool isBootable = false;
+	std::string serial;
+};
+
 static void BootableLog(const char* format, ...)
 {
 #ifdef SCAN_LOG
@@ -108,10 +125,8 @@ bool TryUpdateLastBootedTime(const fs::path& path)
 	}
 }
 
-void ScanBootables(const fs::path& parentPath, bool recursive)
+static void CollectBootableCandidates(const fs::path& parentPath, bool recursive, std::vector<fs::path>& candidates)
 {
-	BootableLog("Entering ScanBootables(path = '%s', recursive = %d);\r\n",
-	            parentPath.string().c_str(), static_cast<int>(recursive));
 	try
 	{
 		std::error_code ec;
@@ -119,28 +134,25 @@ void ScanBootables(const fs::path& parentPath, bool recursive)
 		    pathIterator != fs::directory_iterator(); pathIterator.increment(ec))
 		{
 			auto& path = pathIterator->path();
-			BootableLog("Checking '%s'... ", path.string().c_str());
 			try
 			{
 				if(ec)
 				{
-					BootableLog(" failed to get status: %s.\r\n", ec.message().c_str());
+					BootableLog("Failed to get status of '%s': %s.\r\n", path.string().c_str(), ec.message().c_str());
 					continue;
 				}
 				if(recursive && fs::is_directory(path))
 				{
-					BootableLog("is directory.\r\n");
-					ScanBootables(path, recursive);
+					BootableLog("Entering directory '%s'.\r\n", path.string().c_str());
+					CollectBootableCandidates(path, recursive, candidates);
 					continue;
 				}
-				BootableLog("registering... ");
-				bool success = TryRegisterBootable(path);
-				BootableLog("result = %d\r\n", static_cast<int>(success));
+				candidates.push_back(path);
 			}
 			catch(const std::exception& exception)
 			{
 				//Failed to process a path, keep going
-				BootableLog(" exception: %s\r\n", exception.what());
+				BootableLog("Failed to check '%s': %s\r\n", path.string().c_str(), exception.what());
 			}
 		}
 	}
@@ -148,6 +160,150 @@ void ScanBootables(const fs::path& parentPath, bool recursive)
 	{
 		BootableLog("Caught an exception while trying to list directory: %s\r\n", exception.what());
 	}
+}
+
+static void ExtractDiskIds(std::vector<SCAN_ITEM>& items)
+{
+	//Opening and parsing disc images is the expensive part, spread it over multiple threads
+	std::atomic<size_t> nextItemIndex(0);
+	auto workerProc =
+	    [&]() {
+		    while(true)
+		    {
+			    size_t itemIndex = nextItemIndex++;
+			    if(itemIndex >= items.size()) break;
+			    auto& item = items[itemIndex];
+			    try
+			    {
+				    item.isBootable = DiskUtils::TryGetDiskId(item.path, &item.serial);
+			    }
+			    catch(...)
+			    {
+				    item.isBootable = false;
+			    }
+		    }
+	    };
+
+#ifdef __ANDROID__
+	//Content paths require JNI access, keep everything on the calling thread
+	size_t workerCount = 1;
+#else
+	size_t workerCount = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, SCAN_MAX_WORKERS);
+#endif
+	workerCount = std::min(workerCount, items.size());
+
+	std::vector<std::thread> workers;
+	for(size_t i = 1; i < workerCount; i++)
+	{
+		workers.emplace_back(workerProc);
+	}
+	workerProc();
+	for(auto& worker : workers)
+	{
+		worker.join();
+	}
+}
+
+static void ScanBootableBatch(std::vector<fs::path>::const_iterator begin, std::vector<fs::path>::const_iterator end)
+{
+	auto& client = BootablesDb::CClient::GetInstance();
+	BootablesDb::CTransaction transaction(client);
+
+	std::vector<SCAN_ITEM> discImages;
+	for(auto pathIterator = begin; pathIterator != end; pathIterator++)
+	{
+		const auto& path = *pathIterator;
+		BootableLog("Checking '%s'... ", path.string().c_str());
+		try
+		{
+			if(client.BootableExists(path))
+			{
+				BootableLog("already registered.\r\n");
+				continue;
+			}
+			if(IsBootableExecutablePath(path) || IsBootableArcadeDefPath(path))
+			{
+				BootableLog("registering.\r\n");
+				client.RegisterBootable(path, path.filename().string().c_str(), "");
+				continue;
+			}
+			if(!IsBootableDiscImagePath(path))
+			{
+				BootableLog("not bootable.\r\n");
+				continue;
+			}
+
+			SCAN_ITEM item;
+			item.path = path;
+			std::error_code ec;
+			item.fileSize = fs::file_size(path, ec);
+			if(!ec)
+			{
+				auto lastWriteTime = fs::last_write_time(path, ec);
+				item.lastWriteTime = ec ? 0 : Framework::ConvertFsTimeToSystemTime(lastWriteTime);
+			}
+			item.hasFileInfo = !ec;
+			if(item.hasFileInfo && client.IsScannedFileUnchanged(path, item.fileSize, item.lastWriteTime))
+			{
+				BootableLog("unchanged since last scan.\r\n");
+				continue;
+			}
+			BootableLog("queued.\r\n");
+			discImages.push_back(std::move(item));
+		}
+		catch(const std::exception& exception)
+		{
+			//Failed to process a path, keep going
+			BootableLog(" exception: %s\r\n", exception.what());
+		}
+	}
+
+	ExtractDiskIds(discImages);
+
+	for(const auto& item : discImages)
+	{
+		BootableLog("Disc image '%s': result = %d\r\n", item.path.string().c_str(), static_cast<int>(item.isBootable));
+		try
+		{
+			if(item.isBootable)
+			{
+				client.RegisterBootable(item.path, item.path.filename().string().c_str(), item.serial.c_str());
+			}
+			if(item.hasFileInfo)
+			{
+				client.SetScannedFile(item.path, item.fileSize, item.lastWriteTime);
+			}
+		}
+		catch(const std::exception& exception)
+		{
+			BootableLog("Failed to register '%s': %s\r\n", item.path.string().c_str(), exception.what());
+		}
+	}
+
+	transaction.Commit();
+}
+
+void ScanBootables(const fs::path& parentPath, bool recursive)
+{
+	BootableLog("Entering ScanBootables(path = '%s', recursive = %d);\r\n",
+	            parentPath.string().c_str(), static_cast<int>(recursive));
+
+	std::vector<fs::path> candidates;
+	CollectBootableCandidates(parentPath, recursive, candidates);
+
+	for(size_t batchStart = 0; batchStart < candidates.size(); batchStart += SCAN_BATCH_SIZE)
+	{
+		size_t batchEnd = std::min<size_t>(batchStart + SCAN_BATCH_SIZE, candidates.size());
+		try
+		{
+			ScanBootableBatch(candidates.cbegin() + batchStart, candidates.cbegin() + batchEnd);
+		}
+		catch(const std::exception& exception)
+		{
+			BootableLog("Caught an exception while scanning bootables: %s\r\n", exception.what());
+		}
+	}
+
 	BootableLog("Exiting ScanBootables(path = '%s', recursive = %d);\r\n",
 	            parentPath.string().c_str(), static_cast<int>(recursive));
 }
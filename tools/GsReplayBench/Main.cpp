@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cstring>
+#include <memory>
+#include "filesystem_def.h"
+#include "StdStreamUtils.h"
+#include "FrameDump.h"
+#include "gs/GSH_Null.h"
+#if HAS_GSH_VULKAN
+#include "gs/GSH_Vulkan/GSH_VulkanOffscreen.h"
+#endif
+
+#define FRAMEDUMP_EXTENSION ".dmp.zip"
+#define DEFAULT_ITERATION_COUNT (10)
+
+struct REPLAY_STATS
+{
+	uint32 packetCount = 0;
+	uint32 registerWriteCount = 0;
+	uint32 drawingKickCount = 0;
+	uint32 imagePacketCount = 0;
+	uint64 imageDataSize = 0;
+	uint64 drawCallCount = 0;
+	double wallTime = 0;
+	double cpuTime = 0;
+};
+
+static std::unique_ptr<CGSHandler> CreateGsHandler(const std::string& name)
+{
+	if(name == "null")
+	{
+		return std::make_unique<CGSH_Null>();
+	}
+#if HAS_GSH_VULKAN
+	if(name == "vulkan")
+	{
+		return std::make_unique<CGSH_VulkanOffscreen>();
+	}
+#endif
+	throw std::runtime_error("Unknown or unsupported GS handler '" + name + "'.");
+}
+
+static void GatherFrameDumps(const fs::path& inputPath, std::vector<fs::path>& dumpPaths)
+{
+	if(!fs::is_directory(inputPath))
+	{
+		dumpPaths.push_back(inputPath);
+		return;
+	}
+	for(const auto& entry : fs::directory_iterator(inputPath))
+	{
+		auto entryName = entry.path().filename().string();
+		auto extensionLength = strlen(FRAMEDUMP_EXTENSION);
+		if((entryName.size() > extensionLength) &&
+		   (entryName.compare(entryName.size() - extensionLength, extensionLength, FRAMEDUMP_EXTENSION) == 0))
+		{
+			dumpPaths.push_back(entry.path());
+		}
+	}
+	std::sort(dumpPaths.begin(), dumpPaths.end());
+}
+
+static void ReplayFrameDump(CGSHandler& gs, CFrameDump& frameDump)
+{
+	gs.Reset();
+	gs.InitFromFrameDump(&frameDump);
+
+	for(const auto& packet : frameDump.GetPackets())
+	{
+		if(packet.registerWrites.empty())
+		{
+			gs.ProcessWriteBuffer(nullptr);
+			gs.FeedImageData(packet.imageData.data(), static_cast<uint32>(packet.imageData.size()));
+		}
+		else
+		{
+			for(const auto& registerWrite : packet.registerWrites)
+			{
+				gs.WriteRegister(registerWrite);
+			}
+			gs.ProcessWriteBuffer(&packet.metadata);
+		}
+	}
+
+	gs.ProcessWriteBuffer(nullptr);
+	gs.Finish(true);
+}
+
+static REPLAY_STATS BenchmarkFrameDump(CGSHandler& gs, const fs::path& dumpPath, unsigned int iterationCount)
+{
+	CFrameDump frameDump;
+	{
+		auto inputStream = Framework::CreateInputStdStream(dumpPath.native());
+		frameDump.Read(inputStream);
+	}
+	frameDump.IdentifyDrawingKicks();
+
+	REPLAY_STATS stats;
+	for(const auto& packet : frameDump.GetPackets())
+	{
+		stats.packetCount++;
+		stats.registerWriteCount += static_cast<uint32>(packet.registerWrites.size());
+		if(!packet.imageData.empty())
+		{
+			stats.imagePacketCount++;
+			stats.imageDataSize += packet.imageData.size();
+		}
+	}
+	stats.drawingKickCount = static_cast<uint32>(frameDump.GetDrawingKicks().size());
+
+	//Draw calls are reported by the handler when a frame is marked as done (in Finish)
+	uint64 drawCallCount = 0;
+	auto newFrameConnection = gs.OnNewFrame.Connect(
+	    [&drawCallCount](uint32 frameDrawCallCount) { drawCallCount += frameDrawCallCount; });
+
+	//Warm up caches (textures, shaders, etc.) before measuring
+	ReplayFrameDump(gs, frameDump);
+	drawCallCount = 0;
+
+	auto wallStart = std::chrono::steady_clock::now();
+	auto cpuStart = std::clock();
+	for(unsigned int i = 0; i < iterationCount; i++)
+	{
+		ReplayFrameDump(gs, frameDump);
+	}
+	auto cpuEnd = std::clock();
+	auto wallEnd = std::chrono::steady_clock::now();
+
+	stats.drawCallCount = drawCallCount / iterationCount;
+	stats.wallTime = std::chrono::duration<double>(wallEnd - wallStart).count() / iterationCount;
+	stats.cpuTime = (static_cast<double>(cpuEnd - cpuStart) / CLOCKS_PER_SEC) / iterationCount;
+	return stats;
+}
+
+static void PrintStats(const std::string& name, const REPLAY_STATS& stats)
+{
+	double writesPerSec = (stats.wallTime != 0) ? (stats.registerWriteCount / stats.wallTime) : 0;
+	printf("%s:\n", name.c_str());
+	printf("\tpackets: %d, register writes: %d, drawing kicks: %d, draw calls: %d\n",
+	       stats.packetCount, stats.registerWriteCount, stats.drawingKickCount, static_cast<uint32>(stats.drawCallCount));
+	printf("\timage transfers: %d (%0.2f KiB)\n",
+	       stats.imagePacketCount, static_cast<double>(stats.imageDataSize) / 1024.0);
+	printf("\twall time: %0.3f ms, cpu time: %0.3f ms, %0.2f M register writes/s\n",
+	       stats.wallTime * 1000.0, stats.cpuTime * 1000.0, writesPerSec / 1000000.0);
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 2)
+	{
+		printf("GsReplayBench <frame dump or directory> [null|vulkan] [iteration count]\n");
+		return -1;
+	}
+
+	auto inputPath = fs::path(argv[1]);
+	std::string gsHandlerName = (argc >= 3) ? argv[2] : "null";
+	unsigned int iterationCount = (argc >= 4) ? std::max(atoi(argv[3]), 1) : DEFAULT_ITERATION_COUNT;
+
+	std::vector<fs::path> dumpPaths;
+	std::unique_ptr<CGSHandler> gs;
+	try
+	{
+		GatherFrameDumps(inputPath, dumpPaths);
+		gs = CreateGsHandler(gsHandlerName);
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Error: %s\n", exception.what());
+		return -1;
+	}
+
+	gs->SetLoggingEnabled(false);
+	gs->Initialize();
+	gs->Reset();
+
+	int result = 0;
+	REPLAY_STATS totalStats;
+	for(const auto& dumpPath : dumpPaths)
+	{
+		try
+		{
+			auto stats = BenchmarkFrameDump(*gs, dumpPath, iterationCount);
+			PrintStats(dumpPath.filename().string(), stats);
+			totalStats.wallTime += stats.wallTime;
+			totalStats.cpuTime += stats.cpuTime;
+		}
+		catch(const std::exception& exception)
+		{
+			printf("Failed to replay '%s': %s\n", dumpPath.string().c_str(), exception.what());
+			result = -1;
+		}
+	}
+
+	printf("Total (%d dumps, %d iterations, '%s'): wall time: %0.3f ms, cpu time: %0.3f ms per iteration\n",
+	       static_cast<int>(dumpPaths.size()), iterationCount, gsHandlerName.c_str(),
+	       totalStats.wallTime * 1000.0, totalStats.cpuTime * 1000.0);
+
+	gs->Release();
+	return result;
+}
@@ -1,9 +1,11 @@
+#include <chrono>
 #include <cstdio>
 #include <cassert>
 #include <cstring>
 #include "Ps2Const.h"
 #include "iop/IopBios.h"
 #include "iop/Iop_McServ.h"
+#include "iop/Iop_McFileWriter.h"
 #include "iop/Iop_PathUtils.h"
 #include "iop/Iop_SubSystem.h"
 #include "AppConfig.h"
@@ -100,6 +102,206 @@ void ExecuteTest(const CGameTestSheet::TEST& test)
 	}
 }
 
+static uint32 OpenFile(Iop::CMcServ& mcServ, const char* name, uint32 flags)
+{
+	uint32 result = 0;
+
+	Iop::CMcServ::CMD cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.flags = flags;
+	strncpy(cmd.name, name, sizeof(cmd.name) - 1);
+
+	mcServ.Invoke(MCSERV_CMD(CMD_ID_OPEN), reinterpret_cast<uint32*>(&cmd), sizeof(cmd), &result, sizeof(uint32), nullptr);
+	return result;
+}
+
+static uint32 InvokeFileCommand(Iop::CMcServ& mcServ, uint32 method, uint32 handle, uint32 size, uint32 bufferAddress, uint8* ram)
+{
+	uint32 result = 0;
+
+	Iop::CMcServ::FILECMD cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.handle = handle;
+	cmd.size = size;
+	cmd.bufferAddress = bufferAddress;
+
+	mcServ.Invoke(method | Iop::CMcServ::CMD_FLAG_DIRECT, reinterpret_cast<uint32*>(&cmd), sizeof(cmd), &result, sizeof(uint32), ram);
+	return result;
+}
+
+static std::vector<Iop::CMcServ::ENTRY> GetDir(Iop::CMcServ& mcServ, const char* query)
+{
+	static const int32 maxEntries = 16;
+
+	uint32 result = 0;
+
+	Iop::CMcServ::CMD cmd;
+	memset(&cmd, 0, sizeof(cmd));
+	cmd.maxEntries = maxEntries;
+	strncpy(cmd.name, query, sizeof(cmd.name) - 1);
+
+	std::vector<Iop::CMcServ::ENTRY> entries(maxEntries);
+	mcServ.Invoke(MCSERV_CMD(CMD_ID_GETDIR), reinterpret_cast<uint32*>(&cmd), sizeof(cmd), &result, sizeof(uint32), reinterpret_cast<uint8*>(entries.data()));
+
+	CHECK(static_cast<int32>(result) >= 0);
+	entries.resize(result);
+	return entries;
+}
+
+static const Iop::CMcServ::ENTRY* FindEntry(const std::vector<Iop::CMcServ::ENTRY>& entries, const char* name)
+{
+	for(const auto& entry : entries)
+	{
+		if(strcmp(reinterpret_cast<const char*>(entry.name), name) == 0)
+		{
+			return &entry;
+		}
+	}
+	return nullptr;
+}
+
+static std::vector<uint8> ReadHostFile(const fs::path& path)
+{
+	auto stream = Framework::CreateInputStdStream(path.native());
+	std::vector<uint8> contents(stream.GetLength());
+	stream.Read(contents.data(), contents.size());
+	return contents;
+}
+
+static CGameTestSheet::ENVIRONMENT MakeSaveDirectoryEnvironment()
+{
+	CGameTestSheet::ENVIRONMENT_ACTION action;
+	action.type = CGameTestSheet::ENVIRONMENT_ACTION_CREATE_DIRECTORY;
+	action.name = "/BASLUS-00000";
+	return {action};
+}
+
+void ExecuteFileWriterTest()
+{
+	PrepareTestEnvironment(MakeSaveDirectoryEnvironment());
+
+	auto filePath = fs::path("./memorycard/BASLUS-00000/writer.dat");
+	std::vector<uint8> contents = {0x01, 0x02, 0x03, 0x04};
+
+	{
+		Iop::CMcFileWriter fileWriter;
+		fileWriter.Write(filePath, contents);
+
+		//Contents are either still pending or already being written at this point
+		std::vector<uint8> pendingContents;
+		if(fileWriter.GetPendingContents(filePath, pendingContents))
+		{
+			CHECK(pendingContents == contents);
+		}
+
+		CHECK(fileWriter.Sync());
+		CHECK(!fileWriter.GetPendingContents(filePath, pendingContents));
+		CHECK(!fileWriter.HasFailed(filePath));
+	}
+
+	CHECK(ReadHostFile(filePath) == contents);
+
+	//Writing in a directory that doesn't exist fails, contents must be kept and failure reported
+	auto invalidFilePath = fs::path("./memorycard/BASLUS-99999/writer.dat");
+	{
+		Iop::CMcFileWriter fileWriter;
+		fileWriter.Write(invalidFilePath, contents);
+		CHECK(!fileWriter.Sync());
+		CHECK(fileWriter.HasFailed(invalidFilePath));
+
+		std::vector<uint8> failedContents;
+		CHECK(fileWriter.GetPendingContents(invalidFilePath, failedContents));
+		CHECK(failedContents == contents);
+	}
+
+	CHECK(!fs::exists(invalidFilePath));
+}
+
+void ExecuteBufferedFileTest()
+{
+	static const uint32 writeBufferAddress = 0x100;
+	static const uint32 readBufferAddress = 0x200;
+	static const uint32 dataSize = 0x10;
+
+	PrepareTestEnvironment(MakeSaveDirectoryEnvironment());
+
+	Iop::CSubSystem subSystem(true);
+	subSystem.Reset();
+	auto bios = static_cast<CIopBios*>(subSystem.m_bios.get());
+	bios->Reset(PS2::IOP_BASE_RAM_SIZE, std::shared_ptr<Iop::CSifMan>());
+	auto mcServ = bios->GetMcServ();
+
+	std::vector<uint8> ram(0x400);
+	for(uint32 i = 0; i < dataSize; i++)
+	{
+		ram[writeBufferAddress + i] = static_cast<uint8>(i + 1);
+	}
+
+	uint32 writeHandle = OpenFile(*mcServ, "/BASLUS-00000/save.dat", Iop::CMcServ::OPEN_FLAG_RDWR | Iop::CMcServ::OPEN_FLAG_CREAT);
+	CHECK(static_cast<int32>(writeHandle) >= 0);
+	CHECK(InvokeFileCommand(*mcServ, Iop::CMcServ::CMD_ID_WRITE, writeHandle, dataSize, writeBufferAddress, ram.data()) == dataSize);
+
+	//Another handle on the same file must see data that hasn't been flushed yet
+	uint32 readHandle = OpenFile(*mcServ, "/BASLUS-00000/save.dat", Iop::CMcServ::OPEN_FLAG_RDONLY);
+	CHECK(static_cast<int32>(readHandle) >= 0);
+	CHECK(readHandle != writeHandle);
+	CHECK(InvokeFileCommand(*mcServ, Iop::CMcServ::CMD_ID_READ, readHandle, dataSize, readBufferAddress, ram.data()) == dataSize);
+	CHECK(memcmp(ram.data() + writeBufferAddress, ram.data() + readBufferAddress, dataSize) == 0);
+
+	CHECK(InvokeFileCommand(*mcServ, Iop::CMcServ::CMD_ID_CLOSE, readHandle, 0, 0, ram.data()) == 0);
+	CHECK(InvokeFileCommand(*mcServ, Iop::CMcServ::CMD_ID_CLOSE, writeHandle, 0, 0, ram.data()) == 0);
+
+	//Listing waits for pending writes, file must be there with its final size
+	auto entries = GetDir(*mcServ, "/BASLUS-00000/*");
+	auto entry = FindEntry(entries, "save.dat");
+	CHECK(entry != nullptr);
+	CHECK(entry->size == dataSize);
+
+	auto hostContents = ReadHostFile("./memorycard/BASLUS-00000/save.dat");
+	CHECK(hostContents.size() == dataSize);
+	CHECK(memcmp(hostContents.data(), ram.data() + writeBufferAddress, dataSize) == 0);
+}
+
+void ExecuteListingCacheTest()
+{
+	PrepareTestEnvironment(MakeSaveDirectoryEnvironment());
+
+	Iop::CSubSystem subSystem(true);
+	subSystem.Reset();
+	auto bios = static_cast<CIopBios*>(subSystem.m_bios.get());
+	bios->Reset(PS2::IOP_BASE_RAM_SIZE, std::shared_ptr<Iop::CSifMan>());
+	auto mcServ = bios->GetMcServ();
+
+	//Fill the cache
+	CHECK(FindEntry(GetDir(*mcServ, "/*"), "BASLUS-00000") != nullptr);
+	CHECK(FindEntry(GetDir(*mcServ, "/*"), "BASLUS-00001") == nullptr);
+	CHECK(FindEntry(GetDir(*mcServ, "/BASLUS-00000/*"), "icon.sys") == nullptr);
+
+	auto rootPath = fs::path("./memorycard");
+	auto saveDirPath = rootPath / "BASLUS-00000";
+	auto rootTime = fs::last_write_time(rootPath);
+	auto saveDirTime = fs::last_write_time(saveDirPath);
+
+	//Changes made outside of mcserv must show up in listings.
+	//Timestamps are restored to simulate file systems with coarse modification times.
+	fs::create_directory(rootPath / "BASLUS-00001");
+	Framework::CreateOutputStdStream((saveDirPath / "icon.sys").native());
+	fs::last_write_time(rootPath, rootTime);
+	fs::last_write_time(saveDirPath, saveDirTime);
+
+	CHECK(FindEntry(GetDir(*mcServ, "/*"), "BASLUS-00001") != nullptr);
+	CHECK(FindEntry(GetDir(*mcServ, "/BASLUS-00000/*"), "icon.sys") != nullptr);
+
+	//Same thing, but with a modification time that is guaranteed to be different
+	fs::remove(rootPath / "BASLUS-00001");
+	fs::create_directory(rootPath / "BASLUS-00002");
+	fs::last_write_time(rootPath, rootTime + std::chrono::seconds(2));
+
+	auto entries = GetDir(*mcServ, "/*");
+	CHECK(FindEntry(entries, "BASLUS-00001") == nullptr);
+	CHECK(FindEntry(entries, "BASLUS-00002") != nullptr);
+}
+
 int main(int argc, const char** argv)
 {
 	auto testsPath = fs::path("./tests/");
@@ -120,5 +322,9 @@ int main(int argc, const char** argv)
 		}
 	}
 
+	ExecuteFileWriterTest();
+	ExecuteBufferedFileTest();
+	ExecuteListingCacheTest();
+
 	return 0;
 }
@@ -14,6 +14,7 @@ CPsfSubSystem::CPsfSubSystem(uint32 ramSize)
     , m_cpu(MEMORYMAP_ENDIAN_LSBF)
     , m_copScu(MIPS_REGSIZE_32)
     , m_copFpu(MIPS_REGSIZE_32)
+    , m_spuSampleCache(SPURAMSIZE)
     , m_spuCore0(m_spuRam, SPURAMSIZE, &m_spuSampleCache, &m_irqWatcher, 0)
     , m_spuCore1(m_spuRam, SPURAMSIZE, &m_spuSampleCache, &m_irqWatcher, 1)
     , m_bios(m_cpu, m_ram, ramSize)
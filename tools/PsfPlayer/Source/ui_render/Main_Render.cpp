@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+#include "string_format.h"
+#include "string_cast.h"
+#include "filesystem_def.h"
+#include "PsfVm.h"
+#include "PsfLoader.h"
+#include "PsfArchive.h"
+#include "PsfTags.h"
+#include "Playlist.h"
+#include "SoundHandler.h"
+#include "StdStreamUtils.h"
+#include "ThreadPool.h"
+
+#define DEFAULT_TRACK_LENGTH (60.0)
+#define DEFAULT_TRACK_FADE (10.0)
+
+//Rendering stops if the VM didn't produce any sample for that long (ie.: PSF failed to boot)
+#define RENDER_STALL_TIMEOUT_SEC (10)
+
+struct RENDER_JOB
+{
+	fs::path path;
+	fs::path archivePath;
+	fs::path outputPath;
+};
+typedef std::vector<RENDER_JOB> RenderJobList;
+
+//Shared between a render job and the sound handler owned by its VM
+struct RENDER_STATE
+{
+	std::mutex mutex;
+	std::condition_variable doneCondition;
+	bool done = false;
+	bool receivedSamples = false;
+	double length = DEFAULT_TRACK_LENGTH;
+	double fade = DEFAULT_TRACK_FADE;
+	unsigned int sampleRate = 0;
+	std::vector<int16> samples;
+};
+
+//Accumulates samples as fast as the VM can produce them and applies the fade out
+//Always reports free buffers so that the VM never waits for playback
+class CRenderSoundHandler : public CSoundHandler
+{
+public:
+	CRenderSoundHandler(RENDER_STATE& state)
+	    : m_state(state)
+	{
+	}
+
+	void Reset() override
+	{
+	}
+
+	void Write(int16* samples, unsigned int sampleCount, unsigned int sampleRate) override
+	{
+		std::unique_lock<std::mutex> stateLock(m_state.mutex);
+		if(m_state.done) return;
+
+		m_state.receivedSamples = true;
+		if(m_state.sampleRate == 0)
+		{
+			m_state.sampleRate = sampleRate;
+			m_fadeStart = static_cast<size_t>(m_state.length * sampleRate) * 2;
+			m_totalSize = m_fadeStart + static_cast<size_t>(m_state.fade * sampleRate) * 2;
+			m_state.samples.reserve(m_totalSize);
+		}
+
+		auto& output = m_state.samples;
+		size_t copySize = std::min<size_t>(sampleCount, m_totalSize - output.size());
+		size_t outputBase = output.size();
+		output.insert(output.end(), samples, samples + copySize);
+
+		size_t fadeSize = m_totalSize - m_fadeStart;
+		for(size_t i = std::max(outputBase, m_fadeStart); i < output.size(); i++)
+		{
+			float ratio = static_cast<float>(m_totalSize - i) / static_cast<float>(fadeSize);
+			output[i] = static_cast<int16>(static_cast<float>(output[i]) * ratio);
+		}
+
+		if(output.size() == m_totalSize)
+		{
+			m_state.done = true;
+			m_state.doneCondition.notify_all();
+		}
+	}
+
+	bool HasFreeBuffers() override
+	{
+		return true;
+	}
+
+	void RecycleBuffers() override
+	{
+	}
+
+private:
+	RENDER_STATE& m_state;
+	size_t m_fadeStart = 0;
+	size_t m_totalSize = 0;
+};
+
+static void WriteWaveFile(const fs::path& outputPath, const RENDER_STATE& state)
+{
+	static const uint16 channelCount = 2;
+	static const uint16 bitsPerSample = 16;
+	uint16 blockAlign = channelCount * (bitsPerSample / 8);
+	uint32 dataSize = static_cast<uint32>(state.samples.size() * sizeof(int16));
+
+	auto stream = Framework::CreateOutputStdStream(outputPath.native());
+	stream.Write32(0x46464952); //'RIFF'
+	stream.Write32(36 + dataSize);
+	stream.Write32(0x45564157); //'WAVE'
+	stream.Write32(0x20746D66); //'fmt '
+	stream.Write32(16);
+	stream.Write16(1); //PCM
+	stream.Write16(channelCount);
+	stream.Write32(state.sampleRate);
+	stream.Write32(state.sampleRate * blockAlign);
+	stream.Write16(blockAlign);
+	stream.Write16(bitsPerSample);
+	stream.Write32(0x61746164); //'data'
+	stream.Write32(dataSize);
+	stream.Write(state.samples.data(), dataSize);
+}
+
+static void SetupRenderState(RENDER_STATE& state, const CPsfBase::TagMap& tagMap)
+{
+	CPsfTags tags(tagMap);
+	if(tags.HasTag("length"))
+	{
+		state.length = CPsfTags::ConvertTimeString(tags.GetTagValue("length").c_str());
+	}
+	if(tags.HasTag("fade"))
+	{
+		state.fade = CPsfTags::ConvertTimeString(tags.GetTagValue("fade").c_str());
+	}
+}
+
+static void Render(const RENDER_JOB& job)
+{
+	RENDER_STATE state;
+
+	CPsfVm virtualMachine;
+	CPsfBase::TagMap tagMap;
+	CPsfLoader::LoadPsf(virtualMachine, job.path.wstring(), job.archivePath, &tagMap);
+	SetupRenderState(state, tagMap);
+
+	CPsfTags tags(tagMap);
+	if(tags.HasTag("volume"))
+	{
+		auto volume = tags.GetTagValue("volume");
+		try
+		{
+			virtualMachine.SetVolumeAdjust(std::stof(volume));
+		}
+		catch(const std::logic_error&)
+		{
+			//std::stof throws invalid_argument or out_of_range, both are logic errors
+			printf("Ignoring invalid volume '%s' for '%s', using default volume.\r\n",
+			       string_cast<std::string>(volume).c_str(), job.path.string().c_str());
+		}
+	}
+
+	virtualMachine.SetSpuHandler([&state]() { return new CRenderSoundHandler(state); });
+	virtualMachine.Resume();
+
+	bool stalled = false;
+	{
+		std::unique_lock<std::mutex> stateLock(state.mutex);
+		while(!state.done)
+		{
+			state.receivedSamples = false;
+			state.doneCondition.wait_for(stateLock, std::chrono::seconds(RENDER_STALL_TIMEOUT_SEC));
+			if(!state.done && !state.receivedSamples)
+			{
+				stalled = true;
+				break;
+			}
+		}
+	}
+
+	virtualMachine.Pause();
+	virtualMachine.SetSpuHandler(CPsfVm::SpuHandlerFactory());
+
+	if(stalled)
+	{
+		throw std::runtime_error("Virtual machine stopped producing samples.");
+	}
+
+	WriteWaveFile(job.outputPath, state);
+}
+
+static bool IsLoadablePath(const fs::path& path)
+{
+	auto extension = path.extension().string();
+	if(extension.empty()) return false;
+	return CPlaylist::IsLoadableExtension(extension.c_str() + 1);
+}
+
+//Input path is relative to the input directory, playlist or archive, output mirrors its layout
+static fs::path MakeOutputPath(const fs::path& outputDirPath, const fs::path& inputPath)
+{
+	auto relativePath = inputPath.lexically_normal();
+	bool escapesOutputDir = relativePath.has_root_path() || relativePath.empty() || (*relativePath.begin() == "..");
+	if(escapesOutputDir)
+	{
+		relativePath = inputPath.filename();
+	}
+	auto outputPath = outputDirPath / relativePath;
+	outputPath.replace_extension(".wav");
+	return outputPath;
+}
+
+//Compared without case, output might be written on a case insensitive file system
+static std::string MakeOutputPathKey(const fs::path& outputPath)
+{
+	auto key = outputPath.generic_string();
+	std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+	return key;
+}
+
+//Different inputs can still end up with the same output path (ie.: same name with different extensions)
+static void MakeOutputPathsUnique(RenderJobList& jobs)
+{
+	std::set<std::string> usedPaths;
+	for(auto& job : jobs)
+	{
+		auto outputPath = job.outputPath;
+		for(unsigned int index = 2; usedPaths.count(MakeOutputPathKey(outputPath)) != 0; index++)
+		{
+			outputPath = job.outputPath;
+			outputPath.replace_filename(string_format("%s (%d).wav", job.outputPath.stem().string().c_str(), index));
+		}
+		if(outputPath != job.outputPath)
+		{
+			printf("Output for '%s' already used by another input, writing to '%s' instead.\r\n",
+			       job.path.string().c_str(), outputPath.string().c_str());
+			job.outputPath = outputPath;
+		}
+		usedPaths.insert(MakeOutputPathKey(outputPath));
+	}
+}
+
+static RenderJobList GatherJobs(const fs::path& inputPath, const fs::path& outputDirPath)
+{
+	RenderJobList jobs;
+	if(fs::is_directory(inputPath))
+	{
+		for(const auto& entry : fs::recursive_directory_iterator(inputPath))
+		{
+			const auto& entryPath = entry.path();
+			if(!fs::is_regular_file(entryPath) || !IsLoadablePath(entryPath)) continue;
+			jobs.push_back({entryPath, fs::path(), MakeOutputPath(outputDirPath, entryPath.lexically_relative(inputPath))});
+		}
+	}
+	else if(inputPath.extension() == ".psfpl")
+	{
+		CPlaylist playlist;
+		playlist.Read(inputPath);
+		for(unsigned int i = 0; i < playlist.GetItemCount(); i++)
+		{
+			const auto& item = playlist.GetItem(i);
+			auto archivePath = (item.archiveId == 0) ? fs::path() : fs::path(playlist.GetArchive(item.archiveId));
+			fs::path itemPath = item.path;
+			jobs.push_back({itemPath, archivePath, MakeOutputPath(outputDirPath, itemPath)});
+		}
+	}
+	else if(IsLoadablePath(inputPath))
+	{
+		jobs.push_back({inputPath, fs::path(), MakeOutputPath(outputDirPath, inputPath.filename())});
+	}
+	else
+	{
+		auto archive = std::unique_ptr<CPsfArchive>(CPsfArchive::CreateFromPath(inputPath));
+		for(const auto& fileInfo : archive->GetFiles())
+		{
+			fs::path archiveItemPath = fileInfo.name;
+			if(!IsLoadablePath(archiveItemPath)) continue;
+			jobs.push_back({archiveItemPath, inputPath, MakeOutputPath(outputDirPath, archiveItemPath)});
+		}
+	}
+	MakeOutputPathsUnique(jobs);
+	return jobs;
+}
+
+void PrintUsage()
+{
+	printf("PsfRender usage:\r\n");
+	printf("\tPsfRender [input] [output directory] {worker count}\r\n");
+	printf("\r\n");
+	printf("\t[input] can be a PSF file, a directory, a playlist (.psfpl) or an archive.\r\n");
+	printf("\tTracks are rendered to WAV using their length/fade tags.\r\n");
+	printf("\tOutput files mirror the directory layout of the input.\r\n");
+}
+
+int main(int argc, char** argv)
+{
+	if(argc < 3)
+	{
+		PrintUsage();
+		return -1;
+	}
+
+	fs::path inputPath = argv[1];
+	fs::path outputDirPath = argv[2];
+	unsigned int workerCount = std::max(std::thread::hardware_concurrency(), 1U);
+	if(argc >= 4)
+	{
+		workerCount = std::max(atoi(argv[3]), 1);
+	}
+
+	RenderJobList jobs;
+	try
+	{
+		fs::create_directories(outputDirPath);
+		jobs = GatherJobs(inputPath, outputDirPath);
+		for(const auto& job : jobs)
+		{
+			fs::create_directories(job.outputPath.parent_path());
+		}
+	}
+	catch(const std::exception& exception)
+	{
+		printf("Failed to gather input files: %s\r\n", exception.what());
+		return -1;
+	}
+
+	std::atomic<unsigned int> failedCount(0);
+	{
+		Framework::CThreadPool threadPool(workerCount);
+		for(const auto& job : jobs)
+		{
+			threadPool.Enqueue(
+			    [&job, &failedCount]() {
+				    try
+				    {
+					    Render(job);
+					    printf("Rendered '%s'.\r\n", job.outputPath.string().c_str());
+				    }
+				    catch(const std::exception& exception)
+				    {
+					    printf("Failed to render '%s', reason: '%s'.\r\n",
+					           job.path.string().c_str(), exception.what());
+					    failedCount++;
+				    }
+				    fflush(stdout);
+			    });
+		}
+	}
+
+	printf("Rendered %d file(s), %d failure(s).\r\n",
+	       static_cast<int>(jobs.size() - failedCount), static_cast<int>(failedCount));
+	return (failedCount == 0) ? 0 : -1;
+}
@@ -3,7 +3,7 @@
 
 CTestVm::CTestVm()
     : m_cpu(MEMORYMAP_ENDIAN_LSBF)
-    , m_executor(m_cpu, PS2::MICROMEM1SIZE)
+    , m_executor(m_cpu, PS2::MICROMEM1SIZE, true)
     , m_vuMem(reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::VUMEM1SIZE, 0x10)))
     , m_microMem(reinterpret_cast<uint8*>(framework_aligned_alloc(PS2::MICROMEM1SIZE, 0x10)))
     , m_maVu(PS2::VUMEM1SIZE - 1)